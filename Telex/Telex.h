@@ -4,6 +4,16 @@
 #pragma once
 
 #include <string>
+#include <span>
+
+#if __has_include(<sal.h>)
+#include <sal.h>
+#else
+// SAL annotations are only checked by MSVC
+#define _In_
+#define _Out_
+#define _Success_(expr)
+#endif
 
 namespace VietType {
 namespace Telex {
@@ -51,6 +61,18 @@ struct TelexConfig {
     // optimize key engine for foreign language typing
     unsigned long optimize_multilang = 1;
     bool allow_abbreviations = true;
+
+    friend bool operator==(const TelexConfig&, const TelexConfig&) = default;
+};
+
+// no engine output (Peek/Retrieve/RetrieveRaw) is ever longer than this
+constexpr size_t MaxOutputLength = 256;
+
+// an edit turning one engine output into another: replace `removed` chars at `offset` with `inserted` new chars
+struct OutputDelta {
+    size_t offset;
+    size_t removed;
+    size_t inserted;
 };
 
 class ITelexEngine {
@@ -66,6 +88,8 @@ public:
     virtual TelexStates Backspace() = 0;
     virtual TelexStates Commit() = 0;
     virtual TelexStates Cancel() = 0;
+    // returns BackconvertFailed without changing the word if s is longer than the engine can hold (more than
+    // MaxRawLength + 1 characters)
     virtual TelexStates Backconvert(const std::wstring& s) = 0;
 
     virtual TelexStates GetState() const = 0;
@@ -75,8 +99,32 @@ public:
     virtual std::wstring::size_type Count() const = 0;
 
     virtual bool AcceptsChar(wchar_t c) const = 0;
+
+    // later additions go after the original members, under names of their own: MSVC puts overloads of a virtual next
+    // to each other in the vtable, which would move the slots of Count and AcceptsChar
+
+    virtual size_t RetrieveInto(std::span<wchar_t> out) const = 0;
+    virtual size_t RetrieveRawInto(std::span<wchar_t> out) const = 0;
+    virtual size_t PeekInto(std::span<wchar_t> out) const = 0;
+    // the smallest edit from a previous Peek() result to the current one, writing the inserted chars into out.
+    // like the span overloads below, `inserted` is the full number of inserted chars even if out is smaller, in which
+    // case only the first out.size() of them are written; an out of MaxOutputLength chars always fits
+    virtual OutputDelta PeekDelta(std::wstring_view previous, std::span<wchar_t> out) const = 0;
+
+    // write into a caller-provided buffer and return the length of the whole output,
+    // which might be larger than the buffer (in which case the output is truncated)
+    size_t Retrieve(std::span<wchar_t> out) const {
+        return RetrieveInto(out);
+    }
+    size_t RetrieveRaw(std::span<wchar_t> out) const {
+        return RetrieveRawInto(out);
+    }
+    size_t Peek(std::span<wchar_t> out) const {
+        return PeekInto(out);
+    }
 };
 
+// for callers that only need the abstract interface; see TelexEngine for direct use
 ITelexEngine* TelexNew(const TelexConfig&);
 void TelexDelete(ITelexEngine*);
 
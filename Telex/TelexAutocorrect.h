@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+#include "TelexEngine.h"
+#include "TelexSyllables.h"
+
+namespace VietType {
+namespace Telex {
+
+// autocorrect (see docs/Autocorrect.md) as a table of rules, each rewriting the v or the c2 of a word being committed
+
+// matches any component
+constexpr std::wstring_view AnyComponent = L"*";
+
+enum class AutocorrectTarget : uint8_t {
+    V,
+    C2,
+};
+
+// how _cases follows the rewritten component
+enum class AutocorrectCases : uint8_t {
+    Keep,
+    // v lost the characters added by ResposAutocorrect keys (the 'w' of "nwo")
+    EraseAutocorrectKeys,
+    // c2 gained a character, which takes the case of the first character of c2
+    ExtendC2,
+};
+
+enum AutocorrectConditions : uint8_t {
+    AutocorrectNoCondition = 0,
+    AutocorrectNeedsC1 = 0x1,
+    AutocorrectNeedsC2 = 0x2,
+    // some key made a transition (ResposValidMask)
+    AutocorrectNeedsTransition = 0x4,
+};
+
+constexpr uint8_t ToneBits(std::initializer_list<Tones> tones) {
+    uint8_t bits = 0;
+    for (auto t : tones) {
+        bits |= static_cast<uint8_t>(1 << static_cast<int>(t));
+    }
+    return bits;
+}
+
+constexpr uint8_t AllTones = ToneBits({Tones::Z, Tones::S, Tones::F, Tones::R, Tones::X, Tones::J});
+
+struct AutocorrectRule {
+    // lowercase untoned components that the rule applies to
+    std::wstring_view v = AnyComponent;
+    std::wstring_view c2 = AnyComponent;
+    uint8_t conditions = AutocorrectNoCondition;
+    // ToneBits of the tones that the word may have
+    uint8_t tones = AllTones;
+    // typing flags that must all be set and that must all be clear
+    TypingFlags required = TypingFlags::Zero;
+    TypingFlags excluded = TypingFlags::Zero;
+    AutocorrectTarget target = AutocorrectTarget::V;
+    std::wstring_view replacement;
+    AutocorrectCases cases = AutocorrectCases::Keep;
+};
+
+// letters of v, plus the 'w' that telex leaves in v for autocorrect
+struct AutocorrectVowelAlphabet {
+    static constexpr unsigned int Size = VowelAlphabet::Size + 1;
+    static constexpr unsigned int GetSymbol(wchar_t c) {
+        return c == L'w' ? VowelAlphabet::Size : VowelAlphabet::GetSymbol(c);
+    }
+};
+
+/// <summary>
+/// the v and c2 patterns of the rules are interned as trie nodes, so the rules that may apply to a word come from a
+/// single lookup on its v and c2, as a bitmask of rule indices.
+/// rules see the components as typed: each component is rewritten at most once, by the first rule in table order whose
+/// conditions hold
+/// </summary>
+class AutocorrectRuleSet {
+public:
+    static constexpr size_t MaxRules = 32;
+    static constexpr size_t MaxPatternNodes = 16;
+    using VTrie = ComponentTrie<MaxPatternNodes, AutocorrectVowelAlphabet>;
+    using C2Trie = ComponentTrie<MaxPatternNodes, ConsonantAlphabet>;
+
+    constexpr explicit AutocorrectRuleSet(std::span<const AutocorrectRule> rules) {
+        if (rules.size() > MaxRules) {
+            return;
+        }
+        std::array<VTrie::node_type, MaxRules> vNodes{};
+        std::array<C2Trie::node_type, MaxRules> c2Nodes{};
+        for (size_t i = 0; i < rules.size(); i++) {
+            const auto& rule = rules[i];
+            auto replaceable = rule.target == AutocorrectTarget::V ? Internable<VowelAlphabet>(rule.replacement)
+                                                                   : Internable<ConsonantAlphabet>(rule.replacement);
+            if (!Internable<AutocorrectVowelAlphabet>(rule.v) || !Internable<ConsonantAlphabet>(rule.c2) ||
+                rule.replacement == AnyComponent || !replaceable) {
+                return;
+            }
+            if (rule.v != AnyComponent) {
+                if (_v.size() + rule.v.size() > MaxPatternNodes) {
+                    return;
+                }
+                vNodes[i] = _v.Insert(rule.v);
+            }
+            if (rule.c2 != AnyComponent) {
+                if (_c2.size() + rule.c2.size() > MaxPatternNodes) {
+                    return;
+                }
+                c2Nodes[i] = _c2.Insert(rule.c2);
+            }
+            _rules[i] = rule;
+        }
+        // Dead stands for the components that no pattern names
+        for (size_t v = 0; v < MaxPatternNodes; v++) {
+            for (size_t c2 = 0; c2 < MaxPatternNodes; c2++) {
+                for (size_t i = 0; i < rules.size(); i++) {
+                    if ((rules[i].v == AnyComponent || vNodes[i] == v) &&
+                        (rules[i].c2 == AnyComponent || c2Nodes[i] == c2)) {
+                        _candidates[v][c2] |= uint32_t(1) << i;
+                    }
+                }
+            }
+        }
+        _valid = true;
+    }
+
+    constexpr bool valid() const {
+        return _valid;
+    }
+
+    /// <summary>
+    /// bit i is set if the v and c2 patterns of rule i match
+    /// </summary>
+    constexpr uint32_t Match(std::wstring_view v, std::wstring_view c2) const {
+        return _candidates[_v.Find(v)][_c2.Find(c2)];
+    }
+    constexpr const AutocorrectRule& operator[](size_t i) const {
+        return _rules[i];
+    }
+
+private:
+    template <typename Alphabet>
+    static constexpr bool Internable(std::wstring_view s) {
+        if (s == AnyComponent) {
+            return true;
+        }
+        for (auto c : s) {
+            if (!Alphabet::GetSymbol(c)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::array<AutocorrectRule, MaxRules> _rules{};
+    VTrie _v;
+    C2Trie _c2;
+    // indexed by [v node][c2 node]
+    std::array<std::array<uint32_t, MaxPatternNodes>, MaxPatternNodes> _candidates{};
+    bool _valid = false;
+};
+
+} // namespace Telex
+} // namespace VietType
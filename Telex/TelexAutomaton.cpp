@@ -0,0 +1,536 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "TelexMaps.h"
+#include "TelexEngine.h"
+#include "TelexTables.h"
+#include "TelexAutomaton.h"
+
+namespace VietType {
+namespace Telex {
+
+static size_t CopyOut(_Out_ std::span<wchar_t> out, _In_ std::wstring_view str) {
+    std::copy_n(str.begin(), std::min(str.size(), out.size()), out.begin());
+    return str.size();
+}
+
+static void AddWordPrefixes(std::unordered_set<PackedWord>& prefixes, std::span<const PackedWord> words) {
+    for (auto word : words) {
+        for (size_t length = 0; length <= MaxPackedWordLength; length++) {
+            auto mask = length < MaxPackedWordLength ? (PackedWord(1) << (length * 8)) - 1 : ~PackedWord(0);
+            prefixes.insert(word & mask);
+        }
+    }
+}
+
+// drives TelexEngine for TelexAutomaton::Generate; all keys are typed in lowercase
+class AutomatonGenerator {
+public:
+    explicit AutomatonGenerator(const TelexConfig& config) : _engine(config) {
+        // v and c2 also pass through the keys of the transition and autocorrect tables on their way to a valid syllable
+        AddKeys(_nuclei, Tables::valid_v);
+        AddKeys(_nuclei, Tables::valid_v_q);
+        AddKeys(_nuclei, Tables::valid_v_gi);
+        AddKeys(_nuclei, Tables::valid_v_oa_uy);
+        AddKeys(_nuclei, Tables::typing_styles[static_cast<size_t>(config.typing_style)].transitions);
+        AddKeys(_nuclei, Tables::transitions_w);
+        AddKeys(_nuclei, Tables::transitions_w_q);
+        AddKeys(_nuclei, Tables::transitions_wa);
+        AddKeys(_nuclei, Tables::transitions_wa_q);
+        AddKeys(_nuclei, Tables::transitions_wv_c2);
+        AddKeys(_nuclei, Tables::transitions_wv_c2_q);
+        for (auto v : {L"wu", L"wo", L"wuo", L"ie"}) {
+            AddPrefixes(_nuclei, v);
+        }
+        AddKeys(_codas, Tables::valid_c2);
+        for (auto c2 : {L"h", L"g", L"gn"}) {
+            AddPrefixes(_codas, c2);
+        }
+
+        // the English word lists are checked against the whole word, so words that could still become one of them
+        // have to be told apart
+        auto flags = _engine._cachedFlags;
+        if (static_cast<unsigned long long>(flags & TypingFlags::OptimizeEnDictionary)) {
+            AddWordPrefixes(_prefixes, Tables::wlist_en);
+            if (config.autocorrect) {
+                AddWordPrefixes(_prefixes, Tables::wlist_en_ac);
+            }
+            if (static_cast<unsigned long long>(flags & TypingFlags::OptimizeEnDictionary2)) {
+                AddWordPrefixes(_prefixes, Tables::wlist_en_2);
+            }
+        }
+    }
+
+    const TelexEngine& Replay(std::wstring_view keys) {
+        _engine.Reset();
+        for (auto c : keys) {
+            _engine.PushChar(c);
+        }
+        return _engine;
+    }
+
+    /// <summary>
+    /// pushed is the number of characters that the key adds to the word, dropped is whether it's a ResposDoubleUndo
+    /// </summary>
+    static TelexEngine Push(const TelexEngine& word, wchar_t c, size_t& pushed, bool& dropped) {
+        TelexEngine next(word);
+        next.PushChar(c);
+        pushed = next._cases.size() - word._cases.size();
+        dropped = !next._respos.empty() && next._respos.back() & ResposDoubleUndo;
+        return next;
+    }
+
+    /// <summary>
+    /// everything that PushChar and Commit read from a valid word: two words with the same identity behave the same
+    /// under any further keys, apart from the cases that they push
+    /// </summary>
+    std::wstring Identify(const TelexEngine& e) const {
+        assert(e._state == TelexStates::Valid);
+        std::wstring id;
+        auto push = [&](auto x) { id.push_back(static_cast<wchar_t>(x)); };
+        // for MaxLength and double keys
+        push(e._keyBuffer.size());
+        push(e._keyBuffer.empty() ? 0 : e._keyBuffer.back());
+        auto packed = PackWord(e._keyBuffer);
+        if (packed && _prefixes.contains(*packed)) {
+            id.append(e._keyBuffer);
+        }
+        for (const auto* component : {&e._c1, &e._v, &e._c2}) {
+            push(component->size());
+            id.append(*component);
+        }
+        push(e._t);
+        push(e._toneCount);
+        push(e._respos_current);
+        push(e._resposSummary >> 16);
+        push(e._respos.empty() ? 0 : (e._respos.back() & ~ResposMask) >> 16);
+        // the characters that autocorrect drops
+        for (auto rp : e._respos) {
+            if (rp & ResposAutocorrect) {
+                push(rp & ResposMask);
+            }
+        }
+        return id;
+    }
+
+    /// <summary>
+    /// whether the word can still become a valid syllable, going by its components
+    /// </summary>
+    bool IsViable(const TelexEngine& e) const {
+        return Tables::syllables.FindOnset(e._c1) != SyllableIndex::OnsetTrie::Dead &&
+               _nuclei.contains(std::wstring(e._v)) && _codas.contains(std::wstring(e._c2));
+    }
+
+    TelexAutomaton::State Describe(const TelexEngine& e) const {
+        assert(e._state == TelexStates::Valid);
+        TelexAutomaton::State state;
+        state.state = e._state;
+        state.peek = Render(e, !e._composition.found && e._t != Tones::Z);
+        state.retrieve.append(e._c1).append(e._v).append(e._c2);
+
+        TelexEngine committed(e);
+        state.committed = committed.Commit();
+        if (state.committed == TelexStates::Committed) {
+            VInfo vinfo;
+            state.committedPeek = Render(committed, !committed.GetTonePos(false, &vinfo) && committed._t != Tones::Z);
+            state.committedRetrieve.raw = false;
+            state.committedRetrieve.text.append(committed._c1).append(committed._v).append(committed._c2);
+            // find out where each case bit goes by committing with only that bit set
+            state.committedCases.resize(state.committedRetrieve.text.size());
+            std::fill(state.committedCases.begin(), state.committedCases.end(), NoCase);
+            for (size_t i = 0; i < e._cases.size(); i++) {
+                TelexEngine probe(e);
+                probe._cases.clear();
+                for (size_t j = 0; j < e._cases.size(); j++) {
+                    probe._cases.push_back(i == j);
+                }
+                probe.Commit();
+                auto text = probe.Retrieve();
+                for (size_t j = 0; j < text.size() && j < state.committedCases.size(); j++) {
+                    if (text[j] != state.committedRetrieve.text[j]) {
+                        state.committedCases[j] = static_cast<uint8_t>(i);
+                    }
+                }
+            }
+        }
+        return state;
+    }
+
+    static constexpr uint8_t NoCase = UINT8_MAX;
+
+private:
+    static TelexAutomaton::Output Render(const TelexEngine& e, bool raw) {
+        TelexAutomaton::Output output;
+        output.raw = raw;
+        if (!raw) {
+            output.text = e.Peek();
+        }
+        return output;
+    }
+
+    static void AddPrefixes(std::unordered_set<std::wstring>& prefixes, std::wstring_view s) {
+        for (size_t length = 0; length <= s.size(); length++) {
+            prefixes.emplace(s.substr(0, length));
+        }
+    }
+    template <typename Map>
+    static void AddKeys(std::unordered_set<std::wstring>& prefixes, const Map& map) {
+        for (const auto& item : map) {
+            AddPrefixes(prefixes, item.first);
+        }
+    }
+
+    TelexEngine _engine;
+    std::unordered_set<PackedWord> _prefixes;
+    std::unordered_set<std::wstring> _nuclei;
+    std::unordered_set<std::wstring> _codas;
+};
+
+std::u32string TelexAutomaton::Serialize(const State& state) {
+    std::u32string key;
+    auto push = [&](auto x) { key.push_back(static_cast<char32_t>(x)); };
+    push(state.state);
+    push(state.committed);
+    for (const auto* output : {&state.peek, &state.committedPeek, &state.committedRetrieve}) {
+        push(output->raw);
+        push(output->text.size());
+        key.append(output->text.begin(), output->text.end());
+    }
+    push(state.retrieve.size());
+    key.append(state.retrieve.begin(), state.retrieve.end());
+    key.append(state.committedCases.begin(), state.committedCases.end());
+    return key;
+}
+
+std::shared_ptr<const TelexAutomaton> TelexAutomaton::Generate(const TelexConfig& config, size_t maxStates) {
+    if (config.typing_style >= TypingStyles::Max) {
+        throw std::invalid_argument("invalid typing style");
+    }
+    std::shared_ptr<TelexAutomaton> automaton(new TelexAutomaton());
+    automaton->_config = config;
+    AutomatonGenerator generator(config);
+
+    // one lowercase key for each symbol; keys that the typing style doesn't know all invalidate the word the same way
+    const auto& chartypes = Tables::typing_styles[static_cast<size_t>(config.typing_style)].chartypes;
+    std::wstring keys(1, L'\0');
+    for (wchar_t c = 1; c < 128; c++) {
+        if (chartypes[c] != CharTypes::Uncategorized && ToLower(c) == c) {
+            automaton->_symbols[c] = static_cast<uint8_t>(keys.size());
+            keys.push_back(c);
+        }
+    }
+    auto symbols = keys.size();
+
+    // states found in breadth-first order, each with the keys of the first word that reached it.
+    // states share their outputs with many others (e.g. the same word typed in a different order), so they're kept once
+    std::vector<std::wstring> words{L"", L""};
+    std::vector<uint32_t> stateRecords(2);
+    std::vector<State> records;
+    std::unordered_map<std::u32string, uint32_t> recordIds;
+    auto addRecord = [&](const State& record) {
+        auto [it, added] = recordIds.try_emplace(Serialize(record), static_cast<uint32_t>(records.size()));
+        if (added) {
+            records.push_back(record);
+        }
+        return it->second;
+    };
+    stateRecords[InvalidSink] = addRecord(State());
+    std::vector<uint32_t> transitions;
+    std::unordered_map<std::wstring, state_type> ids;
+    ids.emplace(generator.Identify(generator.Replay(L"")), Root);
+
+    for (state_type s = 0; s < words.size(); s++) {
+        if (s == InvalidSink) {
+            transitions.insert(transitions.end(), symbols, InvalidSink);
+            continue;
+        }
+        auto word = generator.Replay(words[s]);
+        stateRecords[s] = addRecord(generator.Describe(word));
+        for (auto c : keys) {
+            if (!c) {
+                transitions.push_back(InvalidSink);
+                continue;
+            }
+            size_t pushed;
+            bool dropped;
+            auto next = AutomatonGenerator::Push(word, c, pushed, dropped);
+            uint32_t flags = 0;
+            if (dropped) {
+                flags |= TransitionDropKey;
+            }
+            if (next.GetState() != TelexStates::Valid) {
+                transitions.push_back(InvalidSink | flags);
+                continue;
+            }
+            // words that can't be told apart by a single case bit, or that won't make a syllable, are left to the engine
+            if (pushed > 1 || !generator.IsViable(next)) {
+                transitions.push_back(Missing);
+                continue;
+            }
+            if (pushed) {
+                flags |= TransitionPushCase;
+            }
+            auto [it, added] = ids.try_emplace(generator.Identify(next), static_cast<state_type>(words.size()));
+            if (added) {
+                if (words.size() >= maxStates) {
+                    ids.erase(it);
+                    transitions.push_back(Missing);
+                    continue;
+                }
+                words.push_back(words[s] + c);
+                stateRecords.push_back(0);
+            }
+            transitions.push_back(it->second | flags);
+        }
+    }
+    ids.clear();
+    words.clear();
+
+    // merge states that have the same outputs and lead to the same states, until nothing changes
+    auto classes = stateRecords;
+    auto classCount = records.size();
+    while (true) {
+        std::unordered_map<std::u32string, state_type> refined;
+        std::vector<state_type> next(classes.size());
+        for (size_t s = 0; s < classes.size(); s++) {
+            std::u32string key(1, classes[s]);
+            for (size_t i = 0; i < symbols; i++) {
+                auto t = transitions[s * symbols + i];
+                auto target = t & TransitionStateMask;
+                key.push_back(target == Missing ? Missing : classes[target]);
+                key.push_back(t & ~TransitionStateMask);
+            }
+            next[s] = refined.try_emplace(key, static_cast<state_type>(refined.size())).first->second;
+        }
+        classes = std::move(next);
+        if (refined.size() == classCount) {
+            break;
+        }
+        classCount = refined.size();
+    }
+
+    // renumber the classes so that the root and the invalid sink keep their numbers
+    std::vector<state_type> renumbered(classCount, Missing);
+    renumbered[classes[Root]] = Root;
+    renumbered[classes[InvalidSink]] = InvalidSink;
+    state_type count = 2;
+    for (size_t s = 0; s < classes.size(); s++) {
+        if (renumbered[classes[s]] == Missing) {
+            renumbered[classes[s]] = count++;
+        }
+    }
+    automaton->_symbolCount = symbols;
+    automaton->_records = std::move(records);
+    automaton->_stateRecords.resize(count);
+    automaton->_transitions.resize(count * symbols);
+    for (size_t s = 0; s < classes.size(); s++) {
+        auto to = renumbered[classes[s]];
+        automaton->_stateRecords[to] = stateRecords[s];
+        for (size_t i = 0; i < symbols; i++) {
+            auto t = transitions[s * symbols + i];
+            auto target = t & TransitionStateMask;
+            automaton->_transitions[to * symbols + i] =
+                target == Missing ? Missing : (renumbered[classes[target]] | (t & ~TransitionStateMask));
+        }
+    }
+    return automaton;
+}
+
+TelexAutomatonEngine::TelexAutomatonEngine(std::shared_ptr<const TelexAutomaton> automaton)
+    : _automaton(std::move(automaton)), _engine(_automaton->GetConfig()) {
+    Reset();
+}
+
+const TelexConfig& TelexAutomatonEngine::GetConfig() const {
+    return _engine.GetConfig();
+}
+
+void TelexAutomatonEngine::SetConfig(const TelexConfig& config) {
+    Delegate();
+    _engine.SetConfig(config);
+}
+
+void TelexAutomatonEngine::Reset() {
+    _engine.Reset();
+    // the automaton only knows the config it was generated for
+    _delegated = !(_engine.GetConfig() == _automaton->GetConfig());
+    _current = TelexAutomaton::Root;
+    _state = TelexStates::Valid;
+    _keyBuffer.clear();
+    _raw.clear();
+    _cases.clear();
+}
+
+void TelexAutomatonEngine::Delegate() {
+    if (_delegated) {
+        return;
+    }
+    _engine.Reset();
+    for (auto c : _keyBuffer) {
+        _engine.PushChar(c);
+    }
+    if (_state == TelexStates::Committed || _state == TelexStates::CommittedInvalid) {
+        _engine.Commit();
+    }
+    _delegated = true;
+}
+
+TelexStates TelexAutomatonEngine::PushChar(wchar_t c) {
+    if (_delegated) {
+        return _engine.PushChar(c);
+    }
+    if (_state != TelexStates::Valid && _state != TelexStates::Invalid) {
+        return _state;
+    }
+    // see TelexEngine::PushChar
+    if (_keyBuffer.size() > MaxRawLength) {
+        _state = TelexStates::Invalid;
+        return _state;
+    }
+
+    auto lc = ToLower(c);
+    auto t = _automaton->Step(_current, lc);
+    if ((t & TelexAutomaton::TransitionStateMask) == TelexAutomaton::Missing) {
+        Delegate();
+        return _engine.PushChar(c);
+    }
+    _keyBuffer.push_back(c);
+    if (!(t & TelexAutomaton::TransitionDropKey)) {
+        _raw.push_back(c);
+    }
+    if (t & TelexAutomaton::TransitionPushCase) {
+        _cases.push_back(lc != c);
+    }
+    _current = t & TelexAutomaton::TransitionStateMask;
+    _state = _automaton->GetState(_current).state;
+    return _state;
+}
+
+TelexStates TelexAutomatonEngine::Backspace() {
+    Delegate();
+    return _engine.Backspace();
+}
+
+TelexStates TelexAutomatonEngine::Commit() {
+    if (_delegated) {
+        return _engine.Commit();
+    }
+    if (_state == TelexStates::Valid) {
+        _state = _automaton->GetState(_current).committed;
+    } else if (_state == TelexStates::Invalid) {
+        _state = TelexStates::CommittedInvalid;
+    }
+    return _state;
+}
+
+TelexStates TelexAutomatonEngine::Cancel() {
+    Delegate();
+    return _engine.Cancel();
+}
+
+TelexStates TelexAutomatonEngine::Backconvert(const std::wstring& s) {
+    Delegate();
+    return _engine.Backconvert(s);
+}
+
+TelexStates TelexAutomatonEngine::GetState() const {
+    return _delegated ? _engine.GetState() : _state;
+}
+
+std::wstring TelexAutomatonEngine::Retrieve() const {
+    wchar_t buf[MaxOutputLength];
+    return std::wstring(buf, Retrieve(buf));
+}
+
+std::wstring TelexAutomatonEngine::RetrieveRaw() const {
+    wchar_t buf[MaxOutputLength];
+    return std::wstring(buf, RetrieveRaw(buf));
+}
+
+std::wstring TelexAutomatonEngine::Peek() const {
+    wchar_t buf[MaxOutputLength];
+    return std::wstring(buf, Peek(buf));
+}
+
+size_t TelexAutomatonEngine::Render(
+    std::span<wchar_t> out, const TelexAutomaton::Output& output, const CaseBuffer& cases) const {
+    if (output.raw) {
+        return RetrieveRaw(out);
+    }
+    ComponentBuffer result = output.text;
+    for (size_t i = 0; i < result.size() && i < cases.size(); i++) {
+        if (cases[i]) {
+            result[i] = ToUpper(result[i]);
+        }
+    }
+    return CopyOut(out, result);
+}
+
+size_t TelexAutomatonEngine::Retrieve(std::span<wchar_t> out) const {
+    if (_delegated) {
+        return _engine.Retrieve(out);
+    }
+    const auto& state = _automaton->GetState(_current);
+    switch (_state) {
+    case TelexStates::Valid:
+        return Render(out, TelexAutomaton::Output{state.retrieve, false}, _cases);
+    case TelexStates::Committed: {
+        // autocorrect moves the cases around
+        CaseBuffer cases;
+        for (auto i : state.committedCases) {
+            cases.push_back(i < _cases.size() && _cases[i]);
+        }
+        return Render(out, state.committedRetrieve, cases);
+    }
+    default:
+        return RetrieveRaw(out);
+    }
+}
+
+size_t TelexAutomatonEngine::RetrieveRaw(std::span<wchar_t> out) const {
+    if (_delegated) {
+        return _engine.RetrieveRaw(out);
+    }
+    return CopyOut(out, _raw);
+}
+
+size_t TelexAutomatonEngine::Peek(std::span<wchar_t> out) const {
+    if (_delegated) {
+        return _engine.Peek(out);
+    }
+    const auto& state = _automaton->GetState(_current);
+    switch (_state) {
+    case TelexStates::Valid:
+        return Render(out, state.peek, _cases);
+    case TelexStates::Committed: {
+        CaseBuffer cases;
+        for (auto i : state.committedCases) {
+            cases.push_back(i < _cases.size() && _cases[i]);
+        }
+        return Render(out, state.committedPeek, cases);
+    }
+    default:
+        return RetrieveRaw(out);
+    }
+}
+
+OutputDelta TelexAutomatonEngine::PeekDelta(std::wstring_view previous, std::span<wchar_t> out) const {
+    wchar_t buf[MaxOutputLength];
+    return DiffOutput(previous, std::wstring_view(buf, std::min(Peek(buf), std::size(buf))), out);
+}
+
+std::wstring::size_type TelexAutomatonEngine::Count() const {
+    return _delegated ? _engine.Count() : _keyBuffer.size();
+}
+
+bool TelexAutomatonEngine::AcceptsChar(wchar_t c) const {
+    return _engine.AcceptsChar(c);
+}
+
+} // namespace Telex
+} // namespace VietType
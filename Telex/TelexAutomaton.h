@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Telex.h"
+#include "TelexEngine.h"
+
+namespace VietType {
+namespace Telex {
+
+/// <summary>
+/// TelexEngine::PushChar and Commit unrolled into a table: each state carries its rendered output and the outcome of
+/// committing there, and each key is one transition.
+/// states are generated by driving TelexEngine over key sequences from the empty word, merging words whose engine
+/// states can't be told apart by any further key, then minimized. every sequence of valid words is far too many states
+/// (the engine only rejects most of them at Commit), so generation stops at a state budget and transitions past it are
+/// left missing
+/// </summary>
+class TelexAutomaton {
+public:
+    using state_type = uint32_t;
+
+    static constexpr state_type Root = 0;
+    // every key typed into an invalid word leads back here
+    static constexpr state_type InvalidSink = 1;
+    // transition that wasn't generated
+    static constexpr state_type Missing = 0x3fffffff;
+
+    // transitions are a state plus these flags
+    enum TransitionFlags : uint32_t {
+        // the key adds a character to the word, which takes the case of the key
+        TransitionPushCase = 0x80000000,
+        // the key is dropped from the raw output (ResposDoubleUndo)
+        TransitionDropKey = 0x40000000,
+        TransitionStateMask = 0x3fffffff,
+    };
+
+    // lowercase rendering of a word, or its raw keys
+    struct Output {
+        ComponentBuffer text;
+        bool raw = true;
+    };
+
+    struct State {
+        TelexStates state = TelexStates::Invalid;
+        Output peek;
+        // _c1 + _v + _c2
+        ComponentBuffer retrieve;
+        TelexStates committed = TelexStates::CommittedInvalid;
+        Output committedPeek;
+        Output committedRetrieve;
+        // for each character of the committed word, which of the word's case bits it takes
+        FixedVector<uint8_t, MaxLength + 1> committedCases;
+    };
+
+    /// <summary>
+    /// maxStates counts the states found before minimizing
+    /// </summary>
+    static std::shared_ptr<const TelexAutomaton> Generate(const TelexConfig& config, size_t maxStates);
+
+    constexpr const TelexConfig& GetConfig() const {
+        return _config;
+    }
+    size_t size() const {
+        return _stateRecords.size();
+    }
+    const State& GetState(state_type state) const {
+        return _records[_stateRecords[state]];
+    }
+    /// <summary>
+    /// c is a lowercase key
+    /// </summary>
+    uint32_t Step(state_type state, wchar_t c) const {
+        return Transition(state, Symbol(c));
+    }
+    /// <summary>
+    /// Step in two halves, for callers that classify many keys before stepping
+    /// </summary>
+    uint8_t Symbol(wchar_t c) const {
+        auto index = static_cast<std::make_unsigned_t<wchar_t>>(c);
+        return index < _symbols.size() ? _symbols[index] : 0;
+    }
+    uint32_t Transition(state_type state, uint8_t symbol) const {
+        return _transitions[state * _symbolCount + symbol];
+    }
+
+private:
+    TelexAutomaton() = default;
+
+    static std::u32string Serialize(const State& state);
+
+    TelexConfig _config;
+    // lowercase ASCII key to symbol, 0 for keys that invalidate the word
+    std::array<uint8_t, 128> _symbols{};
+    size_t _symbolCount = 1;
+    // distinct states, and which one each state has
+    std::vector<State> _records;
+    std::vector<uint32_t> _stateRecords;
+    // indexed by [state][symbol]
+    std::vector<uint32_t> _transitions;
+};
+
+/// <summary>
+/// ITelexEngine on top of a TelexAutomaton. keys that leave the automaton, and everything but PushChar and Commit, are
+/// handed to a TelexEngine that replays the word; it stays in charge until Reset
+/// </summary>
+class TelexAutomatonEngine final : public ITelexEngine {
+public:
+    explicit TelexAutomatonEngine(std::shared_ptr<const TelexAutomaton> automaton);
+    virtual ~TelexAutomatonEngine() {
+    }
+
+    const TelexConfig& GetConfig() const override;
+    void SetConfig(const TelexConfig& config) override;
+
+    void Reset() override;
+    TelexStates PushChar(wchar_t c) override;
+    TelexStates Backspace() override;
+    TelexStates Commit() override;
+    TelexStates Cancel() override;
+    TelexStates Backconvert(const std::wstring& s) override;
+
+    TelexStates GetState() const override;
+    std::wstring Retrieve() const override;
+    std::wstring RetrieveRaw() const override;
+    std::wstring Peek() const override;
+    size_t Retrieve(std::span<wchar_t> out) const;
+    size_t RetrieveRaw(std::span<wchar_t> out) const;
+    size_t Peek(std::span<wchar_t> out) const;
+    std::wstring::size_type Count() const override;
+
+    bool AcceptsChar(wchar_t c) const override;
+
+    size_t RetrieveInto(std::span<wchar_t> out) const override {
+        return Retrieve(out);
+    }
+    size_t RetrieveRawInto(std::span<wchar_t> out) const override {
+        return RetrieveRaw(out);
+    }
+    size_t PeekInto(std::span<wchar_t> out) const override {
+        return Peek(out);
+    }
+    OutputDelta PeekDelta(std::wstring_view previous, std::span<wchar_t> out) const override;
+
+    /// <summary>
+    /// whether the current word is handled by the replaying engine
+    /// </summary>
+    constexpr bool IsDelegated() const {
+        return _delegated;
+    }
+
+private:
+    void Delegate();
+    size_t Render(std::span<wchar_t> out, const TelexAutomaton::Output& output, const CaseBuffer& cases) const;
+
+    std::shared_ptr<const TelexAutomaton> _automaton;
+    TelexEngine _engine;
+    bool _delegated = false;
+
+    TelexAutomaton::state_type _current = TelexAutomaton::Root;
+    TelexStates _state = TelexStates::Valid;
+    KeyBuffer _keyBuffer;
+    // _keyBuffer without the dropped keys
+    KeyBuffer _raw;
+    CaseBuffer _cases;
+};
+
+} // namespace Telex
+} // namespace VietType
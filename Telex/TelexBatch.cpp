@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include "TelexBatch.h"
+
+namespace VietType {
+namespace Telex {
+
+BatchTyper::BatchTyper(std::shared_ptr<const TelexAutomaton> automaton)
+    : _automaton(std::move(automaton)), _engine(_automaton->GetConfig()) {
+}
+
+void BatchTyper::Step(const PackedWords& words, size_t position) {
+    const auto& automaton = *_automaton;
+    auto count = _active.size();
+    _symbols.resize(count);
+    _upper.resize(count);
+
+    for (size_t j = 0; j < count; j++) {
+        auto c = words.keys[words.offsets[_active[j]] + position];
+        auto lc = ToLower(c);
+        _upper[j] = lc != c;
+        _symbols[j] = automaton.Symbol(lc);
+    }
+
+    for (size_t j = 0; j < count; j++) {
+        auto w = _active[j];
+        auto t = automaton.Transition(_current[w], _symbols[j]);
+        _current[w] = t & TelexAutomaton::TransitionStateMask;
+        _dropped[w] |= static_cast<uint32_t>(!!(t & TelexAutomaton::TransitionDropKey)) << position;
+        auto push = !!(t & TelexAutomaton::TransitionPushCase);
+        _cases[w] |= static_cast<uint32_t>(push & _upper[j]) << _caseCount[w];
+        _caseCount[w] += push;
+    }
+
+    // words that ran out of keys or left the automaton
+    std::erase_if(_active, [&](uint32_t w) {
+        return words.offsets[w + 1] - words.offsets[w] <= position + 1 || _current[w] == TelexAutomaton::Missing;
+    });
+}
+
+void BatchTyper::TypeWords(const PackedWords& words, std::vector<TelexStates>& states, PackedWords& outputs) {
+    auto n = words.size();
+    _current.assign(n, TelexAutomaton::Root);
+    _cases.assign(n, 0);
+    _caseCount.assign(n, 0);
+    _dropped.assign(n, 0);
+    _active.clear();
+    for (uint32_t w = 0; w < n; w++) {
+        auto length = words.offsets[w + 1] - words.offsets[w];
+        if (length > MaxKeys) {
+            _current[w] = TelexAutomaton::Missing;
+        } else if (length) {
+            _active.push_back(w);
+        }
+    }
+    for (size_t position = 0; !_active.empty(); position++) {
+        Step(words, position);
+    }
+
+    states.resize(n);
+    outputs.clear();
+    _delegated = 0;
+    for (uint32_t w = 0; w < n; w++) {
+        auto keys = words[w];
+        if (_current[w] == TelexAutomaton::Missing) {
+            _engine.Reset();
+            for (auto c : keys) {
+                _engine.PushChar(c);
+            }
+            states[w] = _engine.Commit();
+            wchar_t buf[MaxOutputLength];
+            outputs.push_back(std::wstring_view(buf, std::min(_engine.Retrieve(buf), std::size(buf))));
+            _delegated++;
+            continue;
+        }
+
+        // see TelexAutomatonEngine::Commit and Retrieve
+        const auto& state = _automaton->GetState(_current[w]);
+        states[w] = state.state == TelexStates::Valid     ? state.committed
+                    : state.state == TelexStates::Invalid ? TelexStates::CommittedInvalid
+                                                          : state.state;
+        if (states[w] == TelexStates::Committed && !state.committedRetrieve.raw) {
+            ComponentBuffer result = state.committedRetrieve.text;
+            for (size_t i = 0; i < result.size() && i < state.committedCases.size(); i++) {
+                auto k = state.committedCases[i];
+                if (k < _caseCount[w] && ((_cases[w] >> k) & 1)) {
+                    result[i] = ToUpper(result[i]);
+                }
+            }
+            outputs.push_back(result);
+        } else {
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (!((_dropped[w] >> i) & 1)) {
+                    outputs.keys.push_back(keys[i]);
+                }
+            }
+            outputs.offsets.push_back(static_cast<uint32_t>(outputs.keys.size()));
+        }
+    }
+}
+
+} // namespace Telex
+} // namespace VietType
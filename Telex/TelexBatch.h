@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "Telex.h"
+#include "TelexEngine.h"
+#include "TelexAutomaton.h"
+
+namespace VietType {
+namespace Telex {
+
+/// <summary>
+/// words packed back to back: word i is keys[offsets[i], offsets[i + 1])
+/// </summary>
+struct PackedWords {
+    std::vector<wchar_t> keys;
+    std::vector<uint32_t> offsets{0};
+
+    void push_back(std::wstring_view word) {
+        keys.insert(keys.end(), word.begin(), word.end());
+        offsets.push_back(static_cast<uint32_t>(keys.size()));
+    }
+    void clear() {
+        keys.clear();
+        offsets.assign(1, 0);
+    }
+    size_t size() const {
+        return offsets.size() - 1;
+    }
+    std::wstring_view operator[](size_t i) const {
+        return std::wstring_view(keys.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+};
+
+/// <summary>
+/// types many independent words in lockstep through a TelexAutomaton: each round classifies key i of every word still
+/// going into a symbol, then steps all of them, so that the per-word state is kept as a struct of arrays and each pass
+/// is a plain loop over it.
+/// words that leave the automaton or are too long for the case and key bitmasks are typed by a TelexEngine afterwards
+/// </summary>
+class BatchTyper {
+public:
+    // keys per word that the bitmasks hold
+    static constexpr size_t MaxKeys = 32;
+
+    explicit BatchTyper(std::shared_ptr<const TelexAutomaton> automaton);
+
+    /// <summary>
+    /// same as Reset, PushChar of each key, Commit and Retrieve on each word; states and outputs are replaced
+    /// </summary>
+    void TypeWords(const PackedWords& words, std::vector<TelexStates>& states, PackedWords& outputs);
+
+    /// <summary>
+    /// words of the last batch that were typed by the engine
+    /// </summary>
+    constexpr size_t GetDelegatedCount() const {
+        return _delegated;
+    }
+
+private:
+    void Step(const PackedWords& words, size_t position);
+
+    std::shared_ptr<const TelexAutomaton> _automaton;
+    TelexEngine _engine;
+    size_t _delegated = 0;
+
+    // one entry per word
+    std::vector<TelexAutomaton::state_type> _current;
+    // bit i is the case of the i-th character that the keys added
+    std::vector<uint32_t> _cases;
+    std::vector<uint8_t> _caseCount;
+    // bit i is set if key i is left out of the raw output
+    std::vector<uint32_t> _dropped;
+
+    // one entry per word still being stepped
+    std::vector<uint32_t> _active;
+    std::vector<uint8_t> _symbols;
+    std::vector<uint8_t> _upper;
+};
+
+} // namespace Telex
+} // namespace VietType
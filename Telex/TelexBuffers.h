@@ -0,0 +1,226 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <cassert>
+
+namespace VietType {
+namespace Telex {
+
+// fixed-capacity inline containers, so that engine state never touches the heap
+
+template <typename T, size_t N>
+class FixedVector {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    constexpr iterator begin() {
+        return _data;
+    }
+    constexpr const_iterator begin() const {
+        return _data;
+    }
+    constexpr const_iterator cbegin() const {
+        return _data;
+    }
+    constexpr iterator end() {
+        return _data + _size;
+    }
+    constexpr const_iterator end() const {
+        return _data + _size;
+    }
+    constexpr const_iterator cend() const {
+        return _data + _size;
+    }
+    constexpr reverse_iterator rbegin() {
+        return reverse_iterator(end());
+    }
+    constexpr const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+    constexpr reverse_iterator rend() {
+        return reverse_iterator(begin());
+    }
+    constexpr const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    constexpr size_t size() const {
+        return _size;
+    }
+    constexpr size_t length() const {
+        return _size;
+    }
+    static constexpr size_t capacity() {
+        return N;
+    }
+    constexpr bool empty() const {
+        return _size == 0;
+    }
+    constexpr T* data() {
+        return _data;
+    }
+    constexpr const T* data() const {
+        return _data;
+    }
+
+    constexpr reference operator[](size_t pos) {
+        assert(pos < _size);
+        return _data[pos];
+    }
+    constexpr const_reference operator[](size_t pos) const {
+        assert(pos < _size);
+        return _data[pos];
+    }
+    constexpr reference back() {
+        assert(_size > 0);
+        return _data[_size - 1];
+    }
+    constexpr const_reference back() const {
+        assert(_size > 0);
+        return _data[_size - 1];
+    }
+
+    constexpr void clear() {
+        _size = 0;
+    }
+    // overflowing is a logic error, but never write past the buffer
+    constexpr void push_back(const T& value) {
+        assert(_size < N);
+        if (_size < N) {
+            _data[_size++] = value;
+        }
+    }
+    constexpr void pop_back() {
+        assert(_size > 0);
+        _size--;
+    }
+    constexpr void resize(size_t count) {
+        assert(count <= N);
+        count = std::min(count, N);
+        std::fill(_data + std::min(_size, count), _data + count, T{});
+        _size = count;
+    }
+    constexpr iterator erase(const_iterator pos) {
+        assert(pos >= begin() && pos < end());
+        auto it = begin() + (pos - cbegin());
+        std::copy(it + 1, end(), it);
+        _size--;
+        return it;
+    }
+    constexpr void assign(const T* first, size_t count) {
+        assert(count <= N);
+        _size = std::min(count, N);
+        std::copy(first, first + _size, _data);
+    }
+
+private:
+    T _data[N]{};
+    size_t _size = 0;
+};
+
+template <size_t N>
+class FixedString : public FixedVector<wchar_t, N> {
+public:
+    constexpr FixedString() = default;
+
+    constexpr FixedString& operator=(std::wstring_view s) {
+        this->assign(s.data(), s.size());
+        return *this;
+    }
+    constexpr FixedString& append(std::wstring_view s) {
+        for (auto c : s) {
+            this->push_back(c);
+        }
+        return *this;
+    }
+
+    constexpr operator std::wstring_view() const {
+        return std::wstring_view(this->data(), this->size());
+    }
+
+    friend constexpr bool operator==(const FixedString& a, std::wstring_view b) {
+        return std::wstring_view(a) == b;
+    }
+    friend constexpr std::strong_ordering operator<=>(const FixedString& a, std::wstring_view b) {
+        return std::wstring_view(a) <=> b;
+    }
+};
+
+// vector of at most 64 bools kept in a single word; bit i is element i
+template <size_t N>
+class FixedBitVector {
+    static_assert(N <= 64);
+
+public:
+    constexpr size_t size() const {
+        return _size;
+    }
+    static constexpr size_t capacity() {
+        return N;
+    }
+    constexpr bool empty() const {
+        return _size == 0;
+    }
+    constexpr uint64_t bits() const {
+        return _bits;
+    }
+
+    constexpr bool operator[](size_t pos) const {
+        assert(pos < _size);
+        return (_bits >> pos) & 1;
+    }
+    constexpr bool back() const {
+        assert(_size > 0);
+        return (*this)[_size - 1];
+    }
+
+    constexpr void clear() {
+        _bits = 0;
+        _size = 0;
+    }
+    // overflowing is a logic error, but never write past the buffer
+    constexpr void push_back(bool value) {
+        assert(_size < N);
+        if (_size < N) {
+            _bits |= static_cast<uint64_t>(value) << _size++;
+        }
+    }
+    constexpr void pop_back() {
+        assert(_size > 0);
+        _bits &= ~(uint64_t(1) << --_size);
+    }
+    // shifts down the elements after pos
+    constexpr void erase(size_t pos) {
+        assert(pos < _size);
+        auto below = _bits & ((uint64_t(1) << pos) - 1);
+        auto above = pos + 1 < 64 ? (_bits >> (pos + 1)) << pos : 0;
+        _bits = below | above;
+        _size--;
+    }
+
+    friend constexpr bool operator==(const FixedBitVector&, const FixedBitVector&) = default;
+
+private:
+    uint64_t _bits = 0;
+    size_t _size = 0;
+};
+
+} // namespace Telex
+} // namespace VietType
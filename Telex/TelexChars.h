@@ -0,0 +1,350 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include "TelexEngine.h"
+
+namespace VietType {
+namespace Telex {
+
+// case functions hardcode ranges of Vietnamese characters
+// the rest can be correctly transformed or not, doesn't matter
+// these are the definitions; the engine uses the dense tables built from them below
+
+constexpr wchar_t ToUpperByRange(wchar_t c) {
+    wchar_t uc = c & ~32;
+    // Basic Latin
+    if (uc >= L'A' && uc <= L'Z') {
+        return uc;
+    }
+    // Latin-1 Supplement
+    if (c >= L'\xe0' && c <= L'\xfe') {
+        return uc;
+    }
+    // []
+    if (c == L'[' || c == L'{') {
+        return L'{';
+    } else if (c == L']' || c == L'}') {
+        return L'}';
+    }
+    // "uw" exception
+    if (c >= L'\x1af' && c <= L'\x1b0') {
+        return L'\x1af';
+    }
+    uc = c & ~1;
+    // Latin Extended-A/B
+    if (c >= L'\x100' && c <= L'\x1bf') {
+        return uc;
+    }
+    // Latin Extended Additional
+    if (c >= L'\x1ea0' && c <= L'\x1ef9') {
+        return uc;
+    }
+    return c;
+}
+
+constexpr wchar_t ToLowerByRange(wchar_t c) {
+    wchar_t lc = c | 32;
+    // Basic Latin
+    if (lc >= L'a' && lc <= L'z') {
+        return lc;
+    }
+    // Latin-1 Supplement
+    if (c >= L'\xc0' && c <= L'\xde') {
+        return lc;
+    }
+    // []
+    if (c == L'[' || c == L'{') {
+        return L'[';
+    } else if (c == L']' || c == L'}') {
+        return L']';
+    }
+    // "uw" exception
+    if (c >= L'\x1af' && c <= L'\x1b0') {
+        return L'\x1b0';
+    }
+    lc = c | 1;
+    // Latin Extended-A/B
+    if (c >= L'\x100' && c <= L'\x1bf') {
+        return lc;
+    }
+    // Latin Extended Additional
+    if (c >= L'\x1ea0' && c <= L'\x1ef9') {
+        return lc;
+    }
+    return c;
+}
+
+constexpr uint32_t CharIndex(wchar_t c) {
+    return static_cast<std::make_unsigned_t<wchar_t>>(c);
+}
+
+// one entry per character of U+0000-U+01BF and U+1EA0-U+1EF9, which hold every character that the engine maps
+template <typename T>
+class DenseCharTable {
+public:
+    static constexpr wchar_t LowEnd = L'\x1c0';
+    static constexpr wchar_t HighBegin = L'\x1ea0';
+    static constexpr wchar_t HighEnd = L'\x1efa';
+
+    constexpr DenseCharTable() = default;
+    template <typename F>
+    constexpr explicit DenseCharTable(F f) {
+        for (wchar_t c = 0; c < LowEnd; c++) {
+            _low[c] = f(c);
+        }
+        for (wchar_t c = HighBegin; c < HighEnd; c++) {
+            _high[c - HighBegin] = f(c);
+        }
+    }
+
+    /// <summary>
+    /// returns fallback for characters outside of the table
+    /// </summary>
+    constexpr T Get(wchar_t c, T fallback) const {
+        if (CharIndex(c) < LowEnd) {
+            return _low[CharIndex(c)];
+        }
+        if (CharIndex(c) - HighBegin < HighEnd - HighBegin) {
+            return _high[CharIndex(c) - HighBegin];
+        }
+        return fallback;
+    }
+    /// <summary>
+    /// returns false for characters outside of the table
+    /// </summary>
+    constexpr bool Set(wchar_t c, T value) {
+        if (CharIndex(c) < LowEnd) {
+            _low[CharIndex(c)] = value;
+            return true;
+        }
+        if (CharIndex(c) - HighBegin < HighEnd - HighBegin) {
+            _high[CharIndex(c) - HighBegin] = value;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    std::array<T, LowEnd> _low{};
+    std::array<T, HighEnd - HighBegin> _high{};
+};
+
+// both case mappings are the identity outside of the dense ranges
+class CaseTable {
+public:
+    constexpr CaseTable() : _upper(ToUpperByRange), _lower(ToLowerByRange) {
+    }
+
+    constexpr wchar_t ToUpper(wchar_t c) const {
+        return _upper.Get(c, c);
+    }
+    constexpr wchar_t ToLower(wchar_t c) const {
+        return _lower.Get(c, c);
+    }
+
+private:
+    DenseCharTable<wchar_t> _upper;
+    DenseCharTable<wchar_t> _lower;
+};
+
+// vowel x tone to precomposed character, built from a map of each untoned vowel to its 6 toned forms
+class ToneTable {
+public:
+    static constexpr size_t MaxVowels = 16;
+
+    template <typename Map>
+    constexpr explicit ToneTable(const Map& tones) {
+        for (const auto& [vowel, toned] : tones) {
+            if (_count >= MaxVowels || CharIndex(vowel) >= _index.size() || toned.size() != _toned[0].size()) {
+                return;
+            }
+            _index[CharIndex(vowel)] = static_cast<uint8_t>(_count + 1);
+            std::copy(toned.begin(), toned.end(), _toned[_count].begin());
+            _count++;
+        }
+        _valid = true;
+    }
+
+    constexpr bool valid() const {
+        return _valid;
+    }
+
+    /// <summary>
+    /// characters that aren't untoned vowels are returned unchanged
+    /// </summary>
+    constexpr wchar_t Translate(wchar_t c, Tones t) const {
+        if (CharIndex(c) >= _index.size() || !_index[CharIndex(c)]) {
+            return c;
+        }
+        return _toned[_index[CharIndex(c)] - 1][static_cast<size_t>(t)];
+    }
+
+private:
+    // 0 if not a vowel, otherwise 1 + row in _toned
+    std::array<uint8_t, DenseCharTable<wchar_t>::LowEnd> _index{};
+    std::array<std::array<wchar_t, 6>, MaxVowels> _toned{};
+    size_t _count = 0;
+    bool _valid = false;
+};
+
+// UTF-8 encoding of one code point
+struct Utf8Char {
+    std::array<char, 4> bytes{};
+    uint8_t length = 0;
+};
+
+// cp must be a scalar value (not a surrogate, at most U+10FFFF)
+constexpr Utf8Char EncodeUtf8Char(char32_t cp) {
+    if (cp < 0x80) {
+        return Utf8Char{{static_cast<char>(cp)}, 1};
+    } else if (cp < 0x800) {
+        return Utf8Char{{static_cast<char>(0xc0 | (cp >> 6)), static_cast<char>(0x80 | (cp & 0x3f))}, 2};
+    } else if (cp < 0x10000) {
+        return Utf8Char{
+            {static_cast<char>(0xe0 | (cp >> 12)),
+             static_cast<char>(0x80 | ((cp >> 6) & 0x3f)),
+             static_cast<char>(0x80 | (cp & 0x3f))},
+            3};
+    } else {
+        return Utf8Char{
+            {static_cast<char>(0xf0 | (cp >> 18)),
+             static_cast<char>(0x80 | ((cp >> 12) & 0x3f)),
+             static_cast<char>(0x80 | ((cp >> 6) & 0x3f)),
+             static_cast<char>(0x80 | (cp & 0x3f))},
+            4};
+    }
+}
+
+// UTF-8 of the dense ranges, which hold the keys and every precomposed letter of the tone and backconversion tables in
+// both cases. there are no surrogates in the dense ranges
+class Utf8Table {
+public:
+    constexpr Utf8Table() : _table([](wchar_t c) { return EncodeUtf8Char(CharIndex(c)); }) {
+    }
+
+    /// <summary>
+    /// cp must be a scalar value like for EncodeUtf8Char
+    /// </summary>
+    constexpr Utf8Char Get(char32_t cp) const {
+        if (cp < static_cast<char32_t>(DenseCharTable<Utf8Char>::HighEnd)) {
+            auto u = _table.Get(static_cast<wchar_t>(cp), Utf8Char());
+            if (u.length) {
+                return u;
+            }
+        }
+        return EncodeUtf8Char(cp);
+    }
+
+private:
+    DenseCharTable<Utf8Char> _table;
+};
+
+// how a precomposed character is typed: the key of its base letter, then its vowel modifier key and its tone key if it
+// has them, e.g. ấ = a + a + s in telex
+struct CharDecomposition {
+    // the untoned character that the keys leave in c1/v/c2 (e.g. â for ấ), 0 if the character can't be typed
+    wchar_t letter = 0;
+    wchar_t base = 0;
+    wchar_t modifier = 0;
+    wchar_t tone = 0;
+};
+
+// lowercase precomposed characters of one typing style, decomposed from its backconversions
+class BackconversionTable {
+public:
+    constexpr BackconversionTable() = default;
+    /// <summary>
+    /// backconversions maps each character to its keys, tones maps each untoned vowel to its 6 toned forms
+    /// </summary>
+    template <typename BackconversionMap, typename ToneMap>
+    constexpr BackconversionTable(const BackconversionMap& backconversions, const ToneMap& tones) {
+        for (const auto& [c, keys] : backconversions) {
+            auto d = Decompose(c, keys, tones);
+            if (!d.letter || CharIndex(d.base) >= 128 || CharIndex(d.modifier) >= 128 || CharIndex(d.tone) >= 128 ||
+                !_table.Set(c, d)) {
+                return;
+            }
+        }
+        _valid = true;
+    }
+
+    constexpr bool valid() const {
+        return _valid;
+    }
+
+    constexpr CharDecomposition Get(wchar_t c) const {
+        return _table.Get(c, CharDecomposition());
+    }
+
+private:
+    template <typename ToneMap>
+    static constexpr CharDecomposition Decompose(wchar_t c, std::wstring_view keys, const ToneMap& tones) {
+        if (keys.empty()) {
+            return CharDecomposition();
+        }
+        CharDecomposition d{c, keys[0]};
+        bool toned = false;
+        for (const auto& [vowel, toned_forms] : tones) {
+            auto pos = toned_forms.find(c);
+            if (pos != std::wstring_view::npos && pos > 0) {
+                d.letter = vowel;
+                toned = true;
+            }
+        }
+        bool modified = d.letter != d.base;
+        // keys that don't follow the base/modifier/tone layout are not decomposed
+        if (keys.size() != 1u + modified + toned) {
+            return CharDecomposition();
+        }
+        if (modified) {
+            d.modifier = keys[1];
+        }
+        if (toned) {
+            d.tone = keys.back();
+        }
+        return d;
+    }
+
+    DenseCharTable<CharDecomposition> _table;
+    bool _valid = false;
+};
+
+// ASCII characters that a typing style accepts, so that AcceptsChar is a bit test instead of a search in charlist
+class CharBitmap {
+public:
+    constexpr CharBitmap() = default;
+    /// <summary>
+    /// accepts c if charlist has the lowercase form of c
+    /// </summary>
+    constexpr explicit CharBitmap(std::wstring_view charlist) {
+        for (wchar_t c = 0; c < 128; c++) {
+            if (charlist.find(ToLowerByRange(c)) != std::wstring_view::npos) {
+                _bits[c / 64] |= uint64_t(1) << (c % 64);
+            }
+        }
+        // characters outside of ASCII keep their lowercase form outside of ASCII
+        _valid = std::all_of(charlist.begin(), charlist.end(), [](auto c) { return CharIndex(c) < 128; });
+    }
+
+    constexpr bool valid() const {
+        return _valid;
+    }
+
+    constexpr bool Test(wchar_t c) const {
+        return CharIndex(c) < 128 && ((_bits[CharIndex(c) / 64] >> (CharIndex(c) % 64)) & 1);
+    }
+
+private:
+    std::array<uint64_t, 2> _bits{};
+    bool _valid = false;
+};
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include "TelexConverter.h"
+
+namespace VietType {
+namespace Telex {
+
+TextConverter::TextConverter(const TelexConfig& config, size_t cacheCapacity) : _engine(config) {
+    if (cacheCapacity) {
+        _cache.emplace(config, cacheCapacity);
+    }
+}
+
+const TelexConfig& TextConverter::GetConfig() const {
+    return _engine.GetConfig();
+}
+
+bool TextConverter::AcceptsChar(wchar_t c) const {
+    return IsAcceptedChar(GetConfig().typing_style, c);
+}
+
+// passes each word of text and the offset of its end in text to convertWord, and appends the characters between words
+// to out. a word at the end of text goes into word and is continued by the next call
+template <typename IsWordChar, typename ConvertWord>
+static void ForEachWord(
+    std::wstring_view text, std::wstring& word, std::wstring& out, IsWordChar isWordChar, ConvertWord convertWord) {
+    auto it = text.begin();
+    while (it != text.end()) {
+        auto wordEnd = std::find_if_not(it, text.end(), isWordChar);
+        if (wordEnd == text.end()) {
+            word.append(it, wordEnd);
+            break;
+        }
+        auto end = static_cast<size_t>(wordEnd - text.begin());
+        if (!word.empty()) {
+            word.append(it, wordEnd);
+            convertWord(std::wstring_view(word), end);
+            word.clear();
+        } else if (it != wordEnd) {
+            convertWord(std::wstring_view(it, wordEnd), end);
+        }
+        it = std::find_if(wordEnd, text.end(), isWordChar);
+        out.append(wordEnd, it);
+    }
+}
+
+void TextConverter::ConvertWord(std::wstring_view keys, std::wstring& out) {
+    if (keys.size() > MaxRawLength) {
+        out.append(keys);
+        return;
+    }
+    wchar_t buf[MaxOutputLength];
+    if (_cache) {
+        auto result = _cache->TypeWord(keys, buf);
+        out.append(buf, std::min(result.length, std::size(buf)));
+        return;
+    }
+    _engine.Reset();
+    for (auto c : keys) {
+        _engine.PushChar(c);
+    }
+    _engine.Commit();
+    out.append(buf, std::min(_engine.Retrieve(buf), std::size(buf)));
+    _statistics.misses++;
+}
+
+void TextConverter::Convert(std::wstring_view text, std::wstring& out) {
+    ForEachWord(
+        text,
+        _word,
+        out,
+        [this](wchar_t c) { return AcceptsChar(c); },
+        [this, &out](std::wstring_view keys, size_t) { ConvertWord(keys, out); });
+}
+
+void TextConverter::Flush(std::wstring& out) {
+    if (!_word.empty()) {
+        ConvertWord(_word, out);
+        _word.clear();
+    }
+}
+
+TextBackconverter::TextBackconverter(const TelexConfig& config, size_t position)
+    : _engine(config), _position(position) {
+}
+
+const TelexConfig& TextBackconverter::GetConfig() const {
+    return _engine.GetConfig();
+}
+
+bool TextBackconverter::IsWordChar(wchar_t c) const {
+    auto lc = ToLower(c);
+    if (lc >= L'a' && lc <= L'z') {
+        return true;
+    }
+    return IsBackconversionLetter(GetConfig().typing_style, lc);
+}
+
+void TextBackconverter::ConvertWord(
+    std::wstring_view word, size_t offset, std::wstring& out, std::vector<BackconvertFailure>& failures) {
+    _engine.Reset();
+    auto state = _engine.Backconvert(word);
+    std::wstring_view keys(_engine.GetKeyBuffer().data(), _engine.GetKeyBuffer().size());
+    out.append(state == TelexStates::Valid ? keys : word);
+    if (state == TelexStates::Valid) {
+        state = _engine.Commit();
+        wchar_t buf[MaxOutputLength];
+        auto length = _engine.Retrieve(buf);
+        if (state == TelexStates::Committed && std::wstring_view(buf, std::min(length, std::size(buf))) == word) {
+            return;
+        }
+        out.resize(out.size() - keys.size());
+        out.append(word);
+    }
+    failures.push_back(BackconvertFailure{offset, word.size(), state});
+}
+
+void TextBackconverter::Convert(std::wstring_view text, std::wstring& out, std::vector<BackconvertFailure>& failures) {
+    ForEachWord(
+        text,
+        _word,
+        out,
+        [this](wchar_t c) { return IsWordChar(c); },
+        [this, &out, &failures](std::wstring_view word, size_t end) {
+            ConvertWord(word, _position + end - word.size(), out, failures);
+        });
+    _position += text.size();
+}
+
+void TextBackconverter::Flush(std::wstring& out, std::vector<BackconvertFailure>& failures) {
+    if (!_word.empty()) {
+        ConvertWord(_word, _position - _word.size(), out, failures);
+        _word.clear();
+    }
+}
+
+} // namespace Telex
+} // namespace VietType
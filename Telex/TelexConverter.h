@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Telex.h"
+#include "TelexEngine.h"
+#include "TelexWordCache.h"
+
+namespace VietType {
+namespace Telex {
+
+/// <summary>
+/// converts typed text as if it were typed into the IME: a word is a run of characters that the engine accepts, and
+/// any other character is a breaking character (KeyResult::BreakingCharacter) that commits the word and is passed
+/// through as is.
+/// text can be fed in pieces of any size, words that span pieces are carried over. a run of more than MaxRawLength keys
+/// would overflow the engine and is passed through unconverted
+/// </summary>
+class TextConverter {
+public:
+    static constexpr size_t DefaultCacheCapacity = 1 << 14;
+
+    /// <summary>
+    /// words go through a WordCache of cacheCapacity words, or straight to a TelexEngine if cacheCapacity is 0 (for text
+    /// with few repeated words, where the lookups don't pay for themselves)
+    /// </summary>
+    explicit TextConverter(const TelexConfig& config, size_t cacheCapacity = DefaultCacheCapacity);
+
+    const TelexConfig& GetConfig() const;
+    bool AcceptsChar(wchar_t c) const;
+
+    /// <summary>
+    /// appends the converted text to out, except for the word at the end of text which is held until the next call or
+    /// Flush
+    /// </summary>
+    void Convert(std::wstring_view text, std::wstring& out);
+    /// <summary>
+    /// converts the held word
+    /// </summary>
+    void Flush(std::wstring& out);
+
+    /// <summary>
+    /// without a cache, every word typed counts as a miss
+    /// </summary>
+    const WordCache::Statistics& GetStatistics() const {
+        return _cache ? _cache->GetStatistics() : _statistics;
+    }
+
+private:
+    void ConvertWord(std::wstring_view keys, std::wstring& out);
+
+    std::optional<WordCache> _cache;
+    // types the words when there's no cache
+    TelexEngine _engine;
+    WordCache::Statistics _statistics;
+    std::wstring _word;
+};
+
+struct BackconvertFailure {
+    // position of the word in all the text fed so far, in characters
+    size_t offset;
+    size_t length;
+    // the state Backconvert ended in, or the state of committing the keys if they don't give back the word
+    TelexStates state;
+};
+
+/// <summary>
+/// turns Vietnamese text back into the keys that type it: a word is a run of ASCII letters and precomposed characters
+/// of the typing style, and anything else is passed through as is.
+/// words that can't be backconverted, or whose keys don't type the same word again, are passed through and reported.
+/// text can be fed in pieces like TextConverter
+/// </summary>
+class TextBackconverter {
+public:
+    /// <summary>
+    /// position is the offset of the first character that will be fed, for reporting failures
+    /// </summary>
+    explicit TextBackconverter(const TelexConfig& config, size_t position = 0);
+
+    const TelexConfig& GetConfig() const;
+    bool IsWordChar(wchar_t c) const;
+
+    void Convert(std::wstring_view text, std::wstring& out, std::vector<BackconvertFailure>& failures);
+    void Flush(std::wstring& out, std::vector<BackconvertFailure>& failures);
+
+private:
+    void ConvertWord(
+        std::wstring_view word, size_t offset, std::wstring& out, std::vector<BackconvertFailure>& failures);
+
+    TelexEngine _engine;
+    std::wstring _word;
+    size_t _position;
+};
+
+} // namespace Telex
+} // namespace VietType
@@ -5,10 +5,13 @@
 
 #include "TelexMaps.h"
 #include "TelexEngine.h"
+#include "TelexSyllables.h"
+#include "TelexChars.h"
+#include "TelexAutocorrect.h"
 
 #pragma region setup macros
 
-// #define TM_USE_CONSTEXPR
+#define TM_USE_CONSTEXPR
 
 #ifdef TM_USE_CONSTEXPR
 #define TM_CONSTEXPR constexpr
@@ -36,13 +39,25 @@
 #endif
 #endif
 
+// tables whose keys all fit in a PackedKey are searched through a packed copy of their keys
+#define MAKE_PACKED_KEYS(a)                                                                                            \
+    static constexpr bool unique(packable) = CanPackKeys(a.data(), a.size());                                          \
+    static constexpr const auto unique(packed) = PackKeys<unique(packable) ? a.size() : 0>(a)
+#define PACKED_KEYS (unique(packable) ? unique(packed).data() : nullptr)
 #define MAKE_MAP(n, sorted, K, V, ...)                                                                                 \
     static constexpr const std::array<std::pair<K, V>, std::initializer_list<std::pair<K, V>>{__VA_ARGS__}.size()>     \
         unique(array) = {__VA_ARGS__};                                                                                 \
-    static const ArrayMap<K, V, sorted> n(unique(array).data(), unique(array).size())
+    MAKE_PACKED_KEYS(unique(array));                                                                                   \
+    static TM_CONSTEXPR const ArrayMap<K, V, sorted> n(unique(array).data(), unique(array).size(), PACKED_KEYS)
 #define MAKE_SET(n, sorted, K, ...)                                                                                    \
     static constexpr const std::array<K, std::initializer_list<K>{__VA_ARGS__}.size()> unique(array) = {__VA_ARGS__};  \
-    static const ArraySet<K, sorted> n(unique(array).data(), unique(array).size())
+    MAKE_PACKED_KEYS(unique(array));                                                                                   \
+    static TM_CONSTEXPR const ArraySet<K, sorted> n(unique(array).data(), unique(array).size(), PACKED_KEYS)
+// lists of short ASCII words, looked up with a single probe
+#define MAKE_WORD_SET(n, ...)                                                                                          \
+    static constexpr const std::array<std::wstring_view, std::initializer_list<std::wstring_view>{__VA_ARGS__}.size()> \
+        unique(array) = {__VA_ARGS__};                                                                                 \
+    static TM_CONSTEXPR const WordSet<unique(array).size()> n(unique(array))
 #define P(a, b) std::make_pair(std::wstring_view(a), std::wstring_view(b))
 #define P1(a, b) std::make_pair(std::wstring_view(a), b)
 #define P2(a, b) std::make_pair(a, std::wstring_view(b))
@@ -204,6 +219,11 @@ debug_ensure(std::all_of(transitions_tones.begin(), transitions_tones.end(), [](
     return x.second.length() == transitions_tones[0].second.length();
 }));
 
+static TM_CONSTEXPR const ToneTable tone_table(transitions_tones);
+debug_ensure(tone_table.valid());
+
+static TM_CONSTEXPR const CaseTable case_table;
+
 MAKE_SET(
     valid_c1,
     true,
@@ -409,15 +429,130 @@ debug_ensure(std::all_of(valid_v_oa_uy.begin(), valid_v_oa_uy.end(), [](const au
     return std::cmp_less_equal(x.second.tonepos, x.first.length());
 }));
 
+static TM_CONSTEXPR const SyllableIndex syllables(valid_c1, valid_v, valid_v_q, valid_v_gi, valid_v_oa_uy, valid_c2);
+debug_ensure(std::all_of(valid_c1.begin(), valid_c1.end(), [](const auto& x) {
+    return syllables.IsValidOnset(syllables.FindOnset(x));
+}));
+debug_ensure(std::all_of(valid_v.begin(), valid_v.end(), [](const auto& x) {
+    auto found = syllables.GetNucleus(syllables.FindNucleus(x.first), NucleusTable::Plain);
+    return found && found->tonepos == x.second.tonepos && found->c2mode == x.second.c2mode;
+}));
+debug_ensure(std::all_of(valid_c2.begin(), valid_c2.end(), [](const auto& x) {
+    return syllables.GetCoda(syllables.FindCoda(x.first)).restricted == x.second;
+}));
+
+#pragma endregion
+
+#pragma region autocorrect
+
+// see AutocorrectRuleSet; a component is only rewritten by its first matching rule
+static constexpr const AutocorrectRule autocorrect_rule_list[] = {
+    // (telex) "wu" = "ưu"
+    {.v = L"wu", .required = TypingFlags::IsTelex, .replacement = L"\x1b0u"},
+    // (telex) "wo" = "ơ" with c1
+    {
+        .v = L"wo",
+        .conditions = AutocorrectNeedsC1,
+        .required = TypingFlags::IsTelex,
+        .replacement = L"\x1a1",
+        .cases = AutocorrectCases::EraseAutocorrectKeys,
+    },
+    // (telex) "wuo" = "ươ"
+    {
+        .v = L"wuo",
+        .required = TypingFlags::IsTelex,
+        .replacement = L"\x1b0\x1a1",
+        .cases = AutocorrectCases::EraseAutocorrectKeys,
+    },
+    // "ie" + s/j = "iê" with c1 and c2
+    {
+        .v = L"ie",
+        .conditions = AutocorrectNeedsC1 | AutocorrectNeedsC2,
+        .tones = ToneBits({Tones::S, Tones::J}),
+        .replacement = L"i\xea",
+    },
+    // "ah"/"êh" + s/j = "ach"/"êch"
+    {
+        .v = L"a",
+        .c2 = L"h",
+        .tones = ToneBits({Tones::S, Tones::J}),
+        .target = AutocorrectTarget::C2,
+        .replacement = L"ch",
+        .cases = AutocorrectCases::ExtendC2,
+    },
+    {
+        .v = L"\xea",
+        .c2 = L"h",
+        .tones = ToneBits({Tones::S, Tones::J}),
+        .target = AutocorrectTarget::C2,
+        .replacement = L"ch",
+        .cases = AutocorrectCases::ExtendC2,
+    },
+    // "ah"/"êh" + other tones = "anh"/"ênh", unless optimizing (where it needs a transition)
+    {
+        .v = L"a",
+        .c2 = L"h",
+        .tones = ToneBits({Tones::Z, Tones::F, Tones::R, Tones::X}),
+        .excluded = TypingFlags::NoAutocorrectTrailingHWithoutTone,
+        .target = AutocorrectTarget::C2,
+        .replacement = L"nh",
+        .cases = AutocorrectCases::ExtendC2,
+    },
+    {
+        .v = L"a",
+        .c2 = L"h",
+        .conditions = AutocorrectNeedsTransition,
+        .tones = ToneBits({Tones::Z, Tones::F, Tones::R, Tones::X}),
+        .target = AutocorrectTarget::C2,
+        .replacement = L"nh",
+        .cases = AutocorrectCases::ExtendC2,
+    },
+    {
+        .v = L"\xea",
+        .c2 = L"h",
+        .tones = ToneBits({Tones::Z, Tones::F, Tones::R, Tones::X}),
+        .excluded = TypingFlags::NoAutocorrectTrailingHWithoutTone,
+        .target = AutocorrectTarget::C2,
+        .replacement = L"nh",
+        .cases = AutocorrectCases::ExtendC2,
+    },
+    {
+        .v = L"\xea",
+        .c2 = L"h",
+        .conditions = AutocorrectNeedsTransition,
+        .tones = ToneBits({Tones::Z, Tones::F, Tones::R, Tones::X}),
+        .target = AutocorrectTarget::C2,
+        .replacement = L"nh",
+        .cases = AutocorrectCases::ExtendC2,
+    },
+    // "gn" = "ng" with a transition
+    {
+        .c2 = L"gn",
+        .conditions = AutocorrectNeedsTransition,
+        .target = AutocorrectTarget::C2,
+        .replacement = L"ng",
+    },
+    // "g" = "ng" with a transition, unless optimizing
+    {
+        .c2 = L"g",
+        .conditions = AutocorrectNeedsTransition,
+        .excluded = TypingFlags::NoAutocorrectTrailingG,
+        .target = AutocorrectTarget::C2,
+        .replacement = L"ng",
+        .cases = AutocorrectCases::ExtendC2,
+    },
+};
+
+static TM_CONSTEXPR const AutocorrectRuleSet autocorrect_rules(autocorrect_rule_list);
+debug_ensure(autocorrect_rules.valid());
+
 #pragma endregion
 
 #pragma region telex optimize dict
 
 // generated from engscan (optimize=0) doubletone words
-MAKE_SET(
+MAKE_WORD_SET(
     wlist_en,
-    true,
-    std::wstring_view,
     L"airs",     //
     L"arms",     //
     L"auras",    //
@@ -546,12 +681,11 @@ MAKE_SET(
     L"vexes",    //
     L"virus",    //
 );
+debug_ensure(wlist_en.valid());
 
 // generated from dualscan mode 0 (optimize=1)
-MAKE_SET(
+MAKE_WORD_SET(
     wlist_en_2,
-    true,
-    std::wstring_view,
     L"ask",    //
     L"bask",   //
     L"bays",   //
@@ -787,12 +921,11 @@ MAKE_SET(
     L"vips",   //
     L"xix",    //
 );
+debug_ensure(wlist_en_2.valid());
 
 // generated from dualscan mode 1 (optimize=0, autocorrect=1)
-MAKE_SET(
+MAKE_WORD_SET(
     wlist_en_ac,
-    true,
-    std::wstring_view,
     L"ah",     //
     L"ash",    //
     L"bags",   //
@@ -850,6 +983,7 @@ MAKE_SET(
     L"twos",   //
     L"verge",  //
 );
+debug_ensure(wlist_en_ac.valid());
 
 #pragma endregion
 
@@ -1067,7 +1201,7 @@ MAKE_MAP(
     P2(L'\x1ef9', L"y4"),  //
 );
 
-const std::array<const TypingStyle, static_cast<size_t>(TypingStyles::Max)> typing_styles = {
+static TM_CONSTEXPR const std::array<const TypingStyle, static_cast<size_t>(TypingStyles::Max)> typing_styles = {
     // telex
     TypingStyle{
         .chartypes =
@@ -1515,13 +1649,62 @@ debug_ensure(std::all_of(typing_styles.begin(), typing_styles.end(), [](const au
     return true;
 }));
 
+static TM_CONSTEXPR const auto accepted_chars = [] {
+    std::array<CharBitmap, typing_styles.size()> bitmaps;
+    for (size_t i = 0; i < typing_styles.size(); i++) {
+        bitmaps[i] = CharBitmap(typing_styles[i].charlist);
+    }
+    return bitmaps;
+}();
+debug_ensure(std::all_of(accepted_chars.begin(), accepted_chars.end(), [](const auto& x) { return x.valid(); }));
+
+static TM_CONSTEXPR const auto backconversion_tables = [] {
+    std::array<BackconversionTable, typing_styles.size()> tables;
+    for (size_t i = 0; i < typing_styles.size(); i++) {
+        tables[i] = BackconversionTable(typing_styles[i].backconversions, transitions_tones);
+    }
+    return tables;
+}();
+debug_ensure(std::all_of(backconversion_tables.begin(), backconversion_tables.end(), [](const auto& x) {
+    return x.valid();
+}));
+
+// flags of every optimization level of every typing style, each of which TelexEngine compiles its own code paths for
+static constexpr std::pair<TypingStyles, TypingFlags> specialized_flags[] = {
+    {TypingStyles::Telex, TypingFlags::IsTelex},
+    {TypingStyles::Telex, TypingFlags::Level1Telex},
+    {TypingStyles::Telex, TypingFlags::Level2Telex},
+    {TypingStyles::Telex, TypingFlags::Level3Telex},
+    {TypingStyles::Vni, TypingFlags::NoAutocorrectLeadingW},
+    {TypingStyles::TelexComplicated, TypingFlags::IsTelex},
+    {TypingStyles::TelexComplicated, TypingFlags::Level1Telex},
+    {TypingStyles::TelexComplicated, TypingFlags::Level2Telex},
+    {TypingStyles::TelexComplicated, TypingFlags::Level3Telex},
+};
+// a level added to typing_styles needs to be added here too
+debug_ensure([] {
+    for (size_t i = 0; i < typing_styles.size(); i++) {
+        for (unsigned long level = 0; level <= typing_styles[i].max_optimize; level++) {
+            auto flags = typing_styles[i].flags[level];
+            if (std::none_of(std::begin(specialized_flags), std::end(specialized_flags), [&](const auto& x) {
+                    return x.first == static_cast<TypingStyles>(i) && x.second == flags;
+                }))
+                return false;
+        }
+    }
+    return true;
+}());
+
 #pragma endregion
 
 } // namespace Telex
 } // namespace VietType
 
+#undef MAKE_PACKED_KEYS
+#undef PACKED_KEYS
 #undef MAKE_MAP
 #undef MAKE_SET
+#undef MAKE_WORD_SET
 #undef P
 #undef P1
 #undef P2
@@ -5,9 +5,12 @@
 #include <cassert>
 #include <stdexcept>
 #include <bit>
+#include <functional>
+#include <numeric>
 #include "TelexMaps.h"
 #include "TelexEngine.h"
 #include "TelexData.h"
+#include "TelexTables.h"
 
 #define IS(cat, type) (!!static_cast<unsigned int>((cat) & (type)))
 
@@ -22,95 +25,71 @@ void TelexDelete(ITelexEngine* engine) {
     delete engine;
 }
 
-constexpr size_t MaxLength = 10; // enough for "nghieengsz" and "nhuwowngxf"
+// see TelexChars.h for the ranges covered by the case functions
 
-// case functions hardcode ranges of Vietnamese characters
-// the rest can be correctly transformed or not, doesn't matter
+wchar_t ToUpper(_In_ wchar_t c) {
+    return case_table.ToUpper(c);
+}
 
-static wchar_t ToUpper(_In_ wchar_t c) {
-    wchar_t uc = c & ~32;
-    // Basic Latin
-    if (uc >= L'A' && uc <= L'Z') {
-        return uc;
-    }
-    // Latin-1 Supplement
-    if (c >= L'\xe0' && c <= L'\xfe') {
-        return uc;
-    }
-    // []
-    if (c == L'[' || c == L'{') {
-        return L'{';
-    } else if (c == L']' || c == L'}') {
-        return L'}';
-    }
-    // "uw" exception
-    if (c >= L'\x1af' && c <= L'\x1b0') {
-        return L'\x1af';
-    }
-    uc = c & ~1;
-    // Latin Extended-A/B
-    if (c >= L'\x100' && c <= L'\x1bf') {
-        return uc;
-    }
-    // Latin Extended Additional
-    if (c >= L'\x1ea0' && c <= L'\x1ef9') {
-        return uc;
-    }
-    return c;
+wchar_t ToLower(_In_ wchar_t c) {
+    return case_table.ToLower(c);
 }
 
-static wchar_t ToLower(_In_ wchar_t c) {
-    wchar_t lc = c | 32;
-    // Basic Latin
-    if (lc >= L'a' && lc <= L'z') {
-        return lc;
-    }
-    // Latin-1 Supplement
-    if (c >= L'\xc0' && c <= L'\xde') {
-        return lc;
-    }
-    // []
-    if (c == L'[' || c == L'{') {
-        return L'[';
-    } else if (c == L']' || c == L'}') {
-        return L']';
-    }
-    // "uw" exception
-    if (c >= L'\x1af' && c <= L'\x1b0') {
-        return L'\x1b0';
-    }
-    lc = c | 1;
-    // Latin Extended-A/B
-    if (c >= L'\x100' && c <= L'\x1bf') {
-        return lc;
-    }
-    // Latin Extended Additional
-    if (c >= L'\x1ea0' && c <= L'\x1ef9') {
-        return lc;
-    }
-    return c;
+bool IsAcceptedChar(_In_ TypingStyles style, _In_ wchar_t c) {
+    auto typing_style = static_cast<unsigned int>(style);
+    assert(typing_style < accepted_chars.size());
+    return accepted_chars[typing_style].Test(c);
 }
 
+bool IsBackconversionLetter(_In_ TypingStyles style, _In_ wchar_t c) {
+    auto typing_style = static_cast<unsigned int>(style);
+    assert(typing_style < backconversion_tables.size());
+    return backconversion_tables[typing_style].Get(c).letter != 0;
+}
+
+namespace Tables {
+
+const ArrayMap<std::wstring_view, TransitionV, false>& transitions_w = Telex::transitions_w;
+const ArrayMap<std::wstring_view, TransitionV, false>& transitions_w_q = Telex::transitions_w_q;
+const ArrayMap<std::wstring_view, TransitionV, false>& transitions_wa = Telex::transitions_wa;
+const ArrayMap<std::wstring_view, TransitionV, false>& transitions_wa_q = Telex::transitions_wa_q;
+const ArrayMap<std::wstring_view, TransitionV, false>& transitions_wv_c2 = Telex::transitions_wv_c2;
+const ArrayMap<std::wstring_view, TransitionV, false>& transitions_wv_c2_q = Telex::transitions_wv_c2_q;
+const ArraySet<std::wstring_view, true>& valid_c1 = Telex::valid_c1;
+const ArrayMap<std::wstring_view, VInfo, true>& valid_v = Telex::valid_v;
+const ArrayMap<std::wstring_view, VInfo, true>& valid_v_q = Telex::valid_v_q;
+const ArrayMap<std::wstring_view, VInfo, true>& valid_v_gi = Telex::valid_v_gi;
+const ArrayMap<std::wstring_view, VInfo, false>& valid_v_oa_uy = Telex::valid_v_oa_uy;
+const ArrayMap<std::wstring_view, bool, true>& valid_c2 = Telex::valid_c2;
+const SyllableIndex& syllables = Telex::syllables;
+const ArrayMap<wchar_t, std::wstring_view, true>& backconversions_telex = Telex::backconversions_telex;
+const std::array<const TypingStyle, static_cast<size_t>(TypingStyles::Max)>& typing_styles = Telex::typing_styles;
+const std::span<const PackedWord> wlist_en(Telex::wlist_en.begin(), Telex::wlist_en.end());
+const std::span<const PackedWord> wlist_en_2(Telex::wlist_en_2.begin(), Telex::wlist_en_2.end());
+const std::span<const PackedWord> wlist_en_ac(Telex::wlist_en_ac.begin(), Telex::wlist_en_ac.end());
+
+} // namespace Tables
+
 static wchar_t TranslateTone(_In_ wchar_t c, _In_ Tones t) {
-    auto it = transitions_tones.find(c);
     // don't fail here since tone position prediction might give invalid v
-    if (it != transitions_tones.end()) {
-        return (it->second)[(int)t];
-    } else {
-        return c;
-    }
+    return tone_table.Translate(c, t);
 }
 
 /// <summary>destructive</summary>
-static void ApplyCases(_In_ std::wstring& str, _In_ const std::vector<int>& cases) {
+static void ApplyCases(_In_ ComponentBuffer& str, _In_ const CaseBuffer& cases) {
     assert(str.length() == cases.size());
-    for (size_t i = 0; i < cases.size(); i++) {
-        if (cases[i]) {
-            str[i] = ToUpper(str[i]);
-        }
+    // only visit the uppercase characters
+    for (auto bits = cases.bits(); bits; bits &= bits - 1) {
+        auto i = std::countr_zero(bits);
+        str[i] = ToUpper(str[i]);
     }
 }
 
+static size_t CopyOut(_Out_ std::span<wchar_t> out, _In_ std::wstring_view str) {
+    std::copy_n(str.begin(), std::min(str.size(), out.size()), out.begin());
+    return str.size();
+}
+
 static inline Tones GetCharTone(_In_ CharTypes cat) {
     assert(IS(cat, CharTypes::Tone));
     auto bit = std::countr_zero(static_cast<unsigned int>(cat) >> 16);
@@ -118,47 +97,60 @@ static inline Tones GetCharTone(_In_ CharTypes cat) {
     return static_cast<Tones>(bit);
 }
 
-inline CharTypes TelexEngine::ClassifyCharacter(_In_ wchar_t lc) const {
-    const auto& ct = GetTypingStyle()->chartypes;
+template <TypingStyles S>
+inline const TypingStyle* TelexEngine::GetTypingStyle() {
+    static_assert(S < TypingStyles::Max);
+    return &typing_styles[static_cast<size_t>(S)];
+}
+
+template <TypingFlags F>
+inline bool TelexEngine::IsTypingStyle(TypingFlags flag) const {
+    return static_cast<unsigned long long>(F & flag);
+}
+
+template <TypingStyles S>
+inline CharTypes TelexEngine::ClassifyCharacter(_In_ wchar_t lc) {
+    const auto& ct = GetTypingStyle<S>()->chartypes;
     if (lc >= std::size(ct))
         return CharTypes::Uncategorized;
     return ct[lc];
 }
 
 inline void TelexEngine::Invalidate() {
-    _respos.push_back(_respos_current++ | ResposInvalidate);
+    PushRespos(_respos_current++ | ResposInvalidate);
     _state = TelexStates::Invalid;
 }
 
 void TelexEngine::InvalidateAndPopBack(wchar_t c) {
     // pop back only if same char entered twice in a row
     if (_keyBuffer.length() > 1 && c == ToLower(_keyBuffer.rbegin()[1]))
-        _respos.push_back(_respos_current++ | ResposDoubleUndo);
+        PushRespos(_respos_current++ | ResposDoubleUndo);
     else
-        _respos.push_back(_respos_current++ | ResposInvalidate);
+        PushRespos(_respos_current++ | ResposInvalidate);
     _state = TelexStates::Invalid;
 }
 
-std::optional<std::pair<std::wstring_view, VInfo>> TelexEngine::FindTable() const {
-    if (_c1 == L"q") {
-        return valid_v_q.find_opt(_v);
-    } else if (_c1 == L"gi") {
-        return valid_v_gi.find_opt(_v);
-    } else {
-        if (_c2.empty() && !_config.oa_uy_tone1) {
-            auto it = valid_v_oa_uy.find(_v);
-            if (it != valid_v_oa_uy.end())
-                return *it;
-        }
-        return valid_v.find_opt(_v);
+std::optional<VInfo> TelexEngine::FindTable() const {
+    NucleusTable table;
+    switch (syllables.GetOnsetClass(syllables.FindOnset(_c1))) {
+    case OnsetClass::Q:
+        table = NucleusTable::Q;
+        break;
+    case OnsetClass::Gi:
+        table = NucleusTable::Gi;
+        break;
+    default:
+        table = _c2.empty() && !_config.oa_uy_tone1 ? NucleusTable::PlainOaUy : NucleusTable::Plain;
+        break;
     }
+    return syllables.GetNucleus(syllables.FindNucleus(_v), table);
 }
 
 bool TelexEngine::GetTonePos(_In_ bool predict, _Out_ VInfo* vinfo) const {
     auto found = FindTable();
     VInfo retinfo = {0, C2Mode::Either};
     if (found) {
-        retinfo = found->second;
+        retinfo = *found;
     } else if (predict) {
         // guess tone position if _v is not known
         switch (_v.size()) {
@@ -187,13 +179,133 @@ bool TelexEngine::GetTonePos(_In_ bool predict, _Out_ VInfo* vinfo) const {
 }
 
 bool TelexEngine::HasValidRespos() const {
-    return std::any_of(_respos.begin(), _respos.end(), [](auto rp) { return rp & ResposValidMask; });
+    return _resposSummary & ResposValidMask;
+}
+
+void TelexEngine::PushRespos(unsigned int rp) {
+    _respos.push_back(rp);
+    _resposSummary |= rp & ResposValidMask;
 }
 
-void TelexEngine::FeedNewResultChar(std::wstring& target, wchar_t c, bool ccase, unsigned int respos_flags) {
+void TelexEngine::FeedNewResultChar(ComponentBuffer& target, wchar_t c, bool ccase, unsigned int respos_flags) {
     target.push_back(c);
     _cases.push_back(ccase);
-    _respos.push_back(_respos_current++ | respos_flags);
+    PushRespos(_respos_current++ | respos_flags);
+}
+
+// re-render comp for the current word, only starting from the first position that changed since it was last rendered
+void TelexEngine::RenderComposition(Composition& comp, bool full) const {
+    std::wstring_view oldSource(comp.source);
+    auto oldC1 = oldSource.substr(0, comp.c1Length);
+    auto oldV = oldSource.substr(comp.c1Length, comp.vLength);
+    auto oldC2Empty = oldSource.size() == oldC1.size() + oldV.size();
+    // the tone position depends on exactly these (see FindTable)
+    if (full || _v != oldV || (_c1 == L"q") != (oldC1 == L"q") || (_c1 == L"gi") != (oldC1 == L"gi") ||
+        _c2.empty() != oldC2Empty) {
+        comp.found = GetTonePos(false, &comp.vinfo);
+    }
+
+    int toneAt = -1;
+    if (comp.found) {
+        if (comp.vinfo.tonepos < 0 && _c1 == L"gi" && _v.empty()) {
+            // fixup 'gi'
+            toneAt = static_cast<int>(_c1.size()) - 1;
+        } else if (comp.vinfo.tonepos >= 0) {
+            toneAt = static_cast<int>(_c1.size()) + comp.vinfo.tonepos;
+        }
+    }
+
+    ComponentBuffer source;
+    source.append(_c1).append(_v).append(_c2);
+    size_t from = 0;
+    if (!full) {
+        auto mismatch = std::mismatch(source.begin(), source.end(), comp.source.begin(), comp.source.end());
+        from = mismatch.first - source.begin();
+        if (_t != comp.t || toneAt != comp.toneAt) {
+            for (auto at : {toneAt, comp.toneAt}) {
+                if (at >= 0) {
+                    from = std::min(from, static_cast<size_t>(at));
+                }
+            }
+        }
+    }
+
+    comp.text.resize(std::min(from, comp.text.size()));
+    for (auto i = comp.text.size(); i < source.size(); i++) {
+        auto c = source[i];
+        if (static_cast<int>(i) == toneAt) {
+            c = TranslateTone(c, _t);
+        }
+        if (i < _cases.size() && _cases[i]) {
+            c = ToUpper(c);
+        }
+        comp.text.push_back(c);
+    }
+    comp.source = source;
+    comp.c1Length = static_cast<unsigned int>(_c1.size());
+    comp.vLength = static_cast<unsigned int>(_v.size());
+    comp.t = _t;
+    comp.toneAt = toneAt;
+}
+
+void TelexEngine::SaveUndo() {
+    // snapshots must line up with the key buffer, otherwise Rewind() falls back to replaying
+    if (_undoCount != _keyBuffer.size() || _undoCount >= std::size(_undo)) {
+        return;
+    }
+    auto& u = _undo[_undoCount++];
+    u.state = _state;
+    u.t = _t;
+    u.toneCount = _toneCount;
+    u.respos_current = _respos_current;
+    u.resposSummary = _resposSummary;
+    u.chars = _c1;
+    u.chars.append(_v).append(_c2);
+    u.c1Length = static_cast<unsigned int>(_c1.size());
+    u.vLength = static_cast<unsigned int>(_v.size());
+    u.cases = _cases;
+}
+
+// go back to the state right after the first `count` keys of the key buffer were typed
+void TelexEngine::Rewind(size_t count) {
+    assert(count <= _keyBuffer.size() && _respos.size() <= _keyBuffer.size());
+    auto last = std::min(count, _undoCount - 1);
+    const auto& u = _undo[last];
+    std::wstring_view chars(u.chars);
+    _state = u.state;
+    _c1 = chars.substr(0, u.c1Length);
+    _v = chars.substr(u.c1Length, u.vLength);
+    _c2 = chars.substr(u.c1Length + u.vLength);
+    _t = u.t;
+    _toneCount = u.toneCount;
+    _cases = u.cases;
+    _respos_current = u.respos_current;
+    // keys typed into an invalid word don't add to the summary
+    _resposSummary = u.resposSummary;
+    _autocorrected = false;
+    _undoCount = last + 1;
+    if (_state == TelexStates::Valid) {
+        RenderComposition(_composition, true);
+    }
+
+    if (last < count && _state == TelexStates::Invalid) {
+        // keys typed into an invalid word are passthrough keys, which are already in _keyBuffer
+        _respos_current += static_cast<unsigned int>(count - last);
+        last = count;
+    }
+    if (last < count) {
+        // out of snapshots (e.g. the config changed since), replay the remaining keys
+        assert(last <= _respos.size());
+        auto keys = _keyBuffer;
+        _keyBuffer.resize(last);
+        _respos.resize(last);
+        for (auto i = last; i < count; i++) {
+            PushChar(keys[i]);
+        }
+    } else {
+        _keyBuffer.resize(count);
+        _respos.resize(std::min(count, _respos.size()));
+    }
 }
 
 inline const TypingStyle* TelexEngine::GetTypingStyle() const {
@@ -202,16 +314,35 @@ inline const TypingStyle* TelexEngine::GetTypingStyle() const {
     return &typing_styles[typing_style];
 }
 
+template <TypingStyles S, TypingFlags F>
+constexpr TelexEngine::Specialization TelexEngine::Specialize() {
+    return Specialization{
+        S,
+        F,
+        &TelexEngine::DoPushChar<S, F>,
+        &TelexEngine::DoOptimizeAndAutocorrect<S, F>,
+        &TelexEngine::DoBackconvert<S, F>,
+    };
+}
+
+const TelexEngine::Specialization* TelexEngine::FindSpecialization(TypingStyles style, TypingFlags flags) {
+    // one for each optimization level of each typing style, which TelexData.h checks specialized_flags against
+    static constexpr auto specializations = []<size_t... I>(std::index_sequence<I...>) {
+        return std::array{Specialize<specialized_flags[I].first, specialized_flags[I].second>()...};
+    }(std::make_index_sequence<std::size(specialized_flags)>());
+    auto it = std::find_if(specializations.begin(), specializations.end(), [&](const auto& x) {
+        return x.style == style && x.flags == flags;
+    });
+    if (it == specializations.end()) {
+        throw std::logic_error("typing style has no specialization");
+    }
+    return &*it;
+}
+
 TelexEngine::TelexEngine(const TelexConfig& config) {
     if (config.typing_style >= TypingStyles::Max) {
         throw std::invalid_argument("invalid typing style");
     }
-    _keyBuffer.reserve(MaxLength);
-    _c1.reserve(MaxLength);
-    _v.reserve(MaxLength);
-    _c2.reserve(MaxLength);
-    _cases.reserve(MaxLength);
-    _respos.reserve(MaxLength);
     SetConfig(config);
     Reset();
 }
@@ -228,8 +359,14 @@ void TelexEngine::SetConfig(const TelexConfig& config) {
     _config = config;
     auto optimizeLevel = std::min(GetTypingStyle()->max_optimize, _config.optimize_multilang);
     _cachedFlags = GetTypingStyle()->flags[optimizeLevel];
+    _specialization = FindSpecialization(_config.typing_style, _cachedFlags);
+    // snapshots were taken under the old config, make Backspace replay the word instead
+    _undoCount = 1;
     if (last != config.typing_style) {
         Reset();
+    } else if (_state == TelexStates::Valid) {
+        // the tone position depends on oa_uy_tone1
+        RenderComposition(_composition, true);
     }
 }
 
@@ -244,19 +381,25 @@ void TelexEngine::Reset() {
     _cases.clear();
     _respos.clear();
     _respos_current = 0;
+    _resposSummary = 0;
     _backconverted = false;
     _autocorrected = false;
+    _undoCount = 1;
+    // no vowel table has an entry for an empty _v except for 'gi'
+    _composition = Composition();
     assert(CheckInvariants());
 }
 
 // remember to push into _cases when adding a new character
-TelexStates TelexEngine::PushChar(wchar_t corig) {
+template <TypingStyles S, TypingFlags F>
+TelexStates TelexEngine::DoPushChar(wchar_t corig) {
     // PushChar at any committed/error state is illegal, but fail softly anyway
     if (_state != TelexStates::Valid && _state != TelexStates::Invalid) {
         return _state;
     }
+    auto wasValid = _state == TelexStates::Valid;
     // don't let respos overflow into flags
-    if (_keyBuffer.size() > 250) {
+    if (_keyBuffer.size() > MaxRawLength) {
         _state = TelexStates::Invalid;
         assert(CheckInvariants());
         return _state;
@@ -264,15 +407,22 @@ TelexStates TelexEngine::PushChar(wchar_t corig) {
 
     _keyBuffer.push_back(corig);
 
-    if (_state == TelexStates::Invalid || _keyBuffer.size() > MaxLength) {
+    if (!wasValid) {
+        // passthrough key, see _respos
+        _respos_current++;
+        assert(CheckInvariants());
+        return _state;
+    }
+    if (_keyBuffer.size() > MaxLength) {
         Invalidate();
+        SaveUndo();
         assert(CheckInvariants());
         return _state;
     }
 
     wchar_t c = ToLower(corig);
     auto ccase = c != corig;
-    auto cat = ClassifyCharacter(c);
+    auto cat = ClassifyCharacter<S>(c);
     if (cat == CharTypes::Uncategorized) {
         Invalidate();
 
@@ -287,14 +437,14 @@ TelexStates TelexEngine::PushChar(wchar_t corig) {
     } else if (_c1 == L"d" && IS(cat, CharTypes::Dd) && (_config.accept_separate_dd || (_v.empty() && _c2.empty()))) {
         // only used for 'dd'
         _c1 = L"\x111";
-        _respos.push_back(0 | ResposTransitionC1);
+        PushRespos(0 | ResposTransitionC1);
 
     } else if (
         _config.allow_abbreviations && !_c1.empty() && _c1.back() == L'd' && IS(cat, CharTypes::Dd) && _v.empty() &&
         _c2.empty()) {
         // special exception for "QĐ" and the like
         _c1.back() = L'\x111';
-        _respos.push_back(static_cast<unsigned int>(_c1.size() - 1) | ResposTransitionC1);
+        PushRespos(static_cast<unsigned int>(_c1.size() - 1) | ResposTransitionC1);
 
     } else if (!_c1.empty() && _c1.back() == L'\x111' && IS(cat, CharTypes::Dd)) {
         // relaxed constraint: _v.empty()
@@ -325,35 +475,35 @@ TelexStates TelexEngine::PushChar(wchar_t corig) {
         int offset = 0;
         // HACK: single special case for "khongoo"
         // note that _v here is post-append but pre-transition
-        if (!_c2.empty() && IsTypingStyle(TypingFlags::IsTelex) && c == L'o' && _v == L"\xf4o") {
+        if (!_c2.empty() && IsTypingStyle<F>(TypingFlags::IsTelex) && c == L'o' && _v == L"\xf4o") {
             Invalidate();
-        } else if (TransitionV(GetTypingStyle()->transitions, offset)) {
+        } else if (TransitionV(GetTypingStyle<S>()->transitions, offset)) {
             auto after = _v.size();
-            if (IsTypingStyle(TypingFlags::InvalidateOnVowelPostTone) && _toneCount) {
+            if (IsTypingStyle<F>(TypingFlags::InvalidateOnVowelPostTone) && _toneCount) {
                 Invalidate();
             } else if (
                 _keyBuffer.size() > 1 && _respos.back() & ResposTransitionV && c == ToLower(_keyBuffer.rbegin()[1])) {
                 _cases.push_back(ccase);
-                _respos.push_back(_respos_current++ | ResposDoubleUndo);
+                PushRespos(_respos_current++ | ResposDoubleUndo);
             } else if (after < before) {
                 // make sure transitions will only consume the typed character in this case
                 assert(after == before - 1);
-                _respos.push_back(static_cast<unsigned int>(_c1.size() + offset) | ResposTransitionV);
+                PushRespos(static_cast<unsigned int>(_c1.size() + offset) | ResposTransitionV);
             } else if (after == before) {
                 // in case of 'uơi' -> 'ươi', the transition char itself is a normal character
                 // so it must be recorded as such rather than just a transition
                 _cases.push_back(ccase);
-                _respos.push_back(_respos_current++ | ResposTransitionV);
+                PushRespos(_respos_current++ | ResposTransitionV);
             }
         } else if (IS(cat, CharTypes::Vowel)) {
             // if there is no transition, there must be a new character -> must push case
             _cases.push_back(ccase);
             // invalidate if same char entered twice in a row in order to undo transition
             if (_keyBuffer.size() > 1 && _respos.back() & ResposTransitionV && c == ToLower(_keyBuffer.rbegin()[1])) {
-                _respos.push_back(_respos_current++ | ResposDoubleUndo);
+                PushRespos(_respos_current++ | ResposDoubleUndo);
                 _state = TelexStates::Invalid;
             } else {
-                _respos.push_back(_respos_current++);
+                PushRespos(_respos_current++);
             }
             if (!_c2.empty()) {
                 // in case there exists no transition when _c2 is already typed
@@ -382,14 +532,14 @@ TelexStates TelexEngine::PushChar(wchar_t corig) {
                 if (!_c2.empty()) {
                     TransitionV(_c1 == L"q" ? transitions_wv_c2_q : transitions_wv_c2, offset);
                 }
-                _respos.push_back(static_cast<unsigned int>(_c1.size() + offset) | ResposTransitionW);
+                PushRespos(static_cast<unsigned int>(_c1.size() + offset) | ResposTransitionW);
             } else {
                 InvalidateAndPopBack(c);
             }
             // 'w' always keeps V size constant, don't push case
         } else if (
-            !IsTypingStyle(TypingFlags::NoAutocorrectLeadingW) && _config.autocorrect && !_toneCount &&
-            (!_c1.empty() || !IsTypingStyle(TypingFlags::NoAutocorrectLeadingEmptyW))) {
+            !IsTypingStyle<F>(TypingFlags::NoAutocorrectLeadingW) && _config.autocorrect && !_toneCount &&
+            (!_c1.empty() || !IsTypingStyle<F>(TypingFlags::NoAutocorrectLeadingEmptyW))) {
             // at >=1 optimization, autocorrecting "nwuocs" is desirable but "wuocs" not
             FeedNewResultChar(_v, c, ccase, ResposAutocorrect);
         } else {
@@ -400,12 +550,12 @@ TelexStates TelexEngine::PushChar(wchar_t corig) {
         // tones
         auto newtone = GetCharTone(cat);
         if (newtone != _t) {
-            if (IsTypingStyle(TypingFlags::InvalidateDoubleTone) && _toneCount) {
+            if (IsTypingStyle<F>(TypingFlags::InvalidateDoubleTone) && _toneCount) {
                 Invalidate();
             } else {
                 _t = newtone;
                 _toneCount++;
-                _respos.push_back(ResposTone);
+                PushRespos(ResposTone);
             }
         } else {
             InvalidateAndPopBack(c);
@@ -417,11 +567,9 @@ TelexStates TelexEngine::PushChar(wchar_t corig) {
         int offset = 0;
         // special teencode exception
         if (_c1 != L"\x111" && _t != Tones::Z && _t != Tones::S && _t != Tones::J) {
-            wchar_t tmpc2[2] = {c, 0};
-            auto testtone = valid_c2.find(tmpc2);
             // all the c2 that share a prefix have the same restrict value
             // so we should know from just the first character
-            if (testtone != valid_c2.end() && testtone->second)
+            if (syllables.GetCoda(syllables.FindCoda(std::wstring_view(&c, 1))).restricted)
                 success = false;
         }
         if (success) {
@@ -447,6 +595,10 @@ TelexStates TelexEngine::PushChar(wchar_t corig) {
         Invalidate();
     }
 
+    SaveUndo();
+    if (_state == TelexStates::Valid) {
+        RenderComposition(_composition, false);
+    }
     assert(CheckInvariants());
     return _state;
 }
@@ -457,32 +609,49 @@ TelexStates TelexEngine::Backspace() {
     }
 
     [[maybe_unused]] auto prevState = _state;
-    std::wstring buf(_keyBuffer);
-    std::vector<unsigned int> rp(_respos);
+
+    // backspacing gives the same result as replaying the surviving keys from scratch,
+    // but rewinds to the last snapshot shared with the current word instead
 
     if (_state == TelexStates::BackconvertFailed) {
-        _keyBuffer.pop_back();
-        TelexEngine emulate(GetConfig());
-        if (emulate.Backconvert(_keyBuffer) == TelexStates::Valid) {
-            *this = std::move(emulate);
+        // try backconverting the rest of the word again, and stay failed with the shorter word if that doesn't work
+        auto keys = _keyBuffer;
+        keys.pop_back();
+        Reset();
+        if (Backconvert(std::wstring_view(keys)) != TelexStates::Valid) {
+            Reset();
+            _keyBuffer = keys;
+            _state = TelexStates::BackconvertFailed;
+            _backconverted = true;
         }
         return _state;
     } else if (_state == TelexStates::Invalid) {
-        Reset();
-        if (!rp.empty() && rp.back() & ResposDoubleUndo) {
-            buf.pop_back();
+        auto count = _keyBuffer.size();
+        if (_respos.size() == count && !_respos.empty() && _respos.back() & ResposDoubleUndo) {
+            count--;
         }
-        if (!buf.empty()) {
-            buf.pop_back();
+        if (count) {
+            count--;
         }
-        if (!buf.empty() && _config.backspaced_word_stays_invalid) {
+        if (count && _config.backspaced_word_stays_invalid && _respos.empty()) {
+            // nothing but passthrough keys left from an earlier backspace
+            _keyBuffer.pop_back();
+            _respos_current--;
+        } else if (count && _config.backspaced_word_stays_invalid) {
+            // the word is rebuilt as passthrough keys without the ResposDoubleUndo ones, so it no longer shares
+            // snapshots with the old one
+            KeyBuffer keys;
+            for (size_t i = 0; i < count; i++)
+                if (i >= _respos.size() || !(_respos[i] & ResposDoubleUndo))
+                    keys.push_back(_keyBuffer[i]);
+            Reset();
             _state = TelexStates::Invalid;
+            _keyBuffer = keys;
+            _respos_current = static_cast<unsigned int>(keys.size());
+        } else {
+            Rewind(count);
+            _backconverted = false;
         }
-        for (size_t i = 0; i < buf.size(); i++)
-            if (!_config.backspaced_word_stays_invalid || !(rp[i] & ResposDoubleUndo))
-                // if backspaced_word_stays_invalid=1, we need to push all chars in order to reproduce the
-                // ResposDoubleUndo, thus the check
-                PushChar(buf[i]);
         assert(CheckInvariantsBackspace(prevState));
         return _state;
     } else if (_state != TelexStates::Valid) {
@@ -493,36 +662,28 @@ TelexStates TelexEngine::Backspace() {
     VInfo vinfo;
     auto found = GetTonePos(false, &vinfo);
     if (!found && _t != Tones::Z) {
-        Reset();
-        if (!buf.empty()) {
-            buf.pop_back();
-        }
-        for (auto c : buf) {
-            PushChar(c);
-        }
+        Rewind(_keyBuffer.empty() ? 0 : _keyBuffer.size() - 1);
+        _backconverted = false;
         assert(CheckInvariantsBackspace(prevState));
         return _state;
     }
 
     assert(_keyBuffer.size() == _respos.size());
-    rp = _respos;
+    auto rp = _respos;
     bool oldBackconverted = _backconverted;
 
     auto toDelete = static_cast<unsigned int>(_c1.size() + _v.size() + _c2.size()) - 1;
     auto toneWasReset = _c1.size() + vinfo.tonepos >= toDelete;
 
-    Reset();
-
     // scan word for respos that should be expunged
-    // attention that Reset() is already called
 
     if (toneWasReset) {
-        for (size_t i = 0; i < buf.size(); i++)
+        for (size_t i = 0; i < rp.size(); i++)
             if (rp[i] & ResposTone)
                 rp[i] = (rp[i] & ResposMask) | ResposExpunged;
     }
 
-    for (size_t i = 0; i < buf.size(); i++) {
+    for (size_t i = 0; i < rp.size(); i++) {
         if (rp[i] & ResposDoubleUndo && (rp[i] & ResposMask) >= toDelete) {
             assert(i > 0);
             assert(rp[i - 1] & ~ResposMask);
@@ -530,38 +691,49 @@ TelexStates TelexEngine::Backspace() {
         }
     }
 
-    for (size_t i = 0; i < buf.size(); i++)
-        if (!(rp[i] & ResposExpunged) && (rp[i] & ResposMask) < toDelete)
-            PushChar(buf[i]);
-
-    if (!_keyBuffer.empty()) {
-        _backconverted = oldBackconverted;
+    auto survives = [&](size_t i) { return !(rp[i] & ResposExpunged) && (rp[i] & ResposMask) < toDelete; };
+    // keys before the first deleted one are untouched, so rewind to its snapshot and only replay the surviving keys
+    // after it. those are the keys that changed earlier characters after the deleted one was typed (usually just the
+    // tone key, or a w), which is what fixes up the snapshot
+    size_t first = 0;
+    while (first < rp.size() && survives(first)) {
+        first++;
+    }
+    FixedString<MaxLength> replay;
+    for (auto i = first; i < rp.size(); i++)
+        if (survives(i))
+            replay.push_back(_keyBuffer[i]);
+
+    Rewind(first);
+    for (auto c : replay) {
+        PushChar(c);
     }
 
+    _backconverted = !_keyBuffer.empty() && oldBackconverted;
+
     assert(CheckInvariantsBackspace(prevState));
     return _state;
 }
 
+template <TypingStyles S, TypingFlags F>
 TelexStates TelexEngine::DoOptimizeAndAutocorrect() {
     // precondition
     assert(_state == TelexStates::Valid);
 
-    if (IsTypingStyle(TypingFlags::OptimizeEnDictionary)) {
-        std::wstring wordBuffer = _keyBuffer;
-        for (auto& c : wordBuffer) {
-            c = ToLower(c);
-        }
-        if (wlist_en.find(wordBuffer) != wlist_en.end()) {
+    // words that can't be packed aren't in any of the lists
+    auto word = PackWord(_keyBuffer, ToLower);
+    if (IsTypingStyle<F>(TypingFlags::OptimizeEnDictionary) && word) {
+        if (wlist_en.contains(*word)) {
             _state = TelexStates::CommittedInvalid;
             assert(CheckInvariants());
             return _state;
         }
-        if (_config.autocorrect && wlist_en_ac.find(wordBuffer) != wlist_en_ac.end()) {
+        if (_config.autocorrect && wlist_en_ac.contains(*word)) {
             _state = TelexStates::CommittedInvalid;
             assert(CheckInvariants());
             return _state;
         }
-        if (IsTypingStyle(TypingFlags::OptimizeEnDictionary2) && wlist_en_2.find(wordBuffer) != wlist_en_2.end()) {
+        if (IsTypingStyle<F>(TypingFlags::OptimizeEnDictionary2) && wlist_en_2.contains(*word)) {
             _state = TelexStates::CommittedInvalid;
             assert(CheckInvariants());
             return _state;
@@ -569,50 +741,38 @@ TelexStates TelexEngine::DoOptimizeAndAutocorrect() {
     }
 
     if (_config.autocorrect && !_backconverted && _toneCount < 2) {
-        // fixing respos might not be necessary here but fixing cases is
-        // HACK
-        if (IsTypingStyle(TypingFlags::IsTelex)) {
-            if (_v == L"wu") {
-                _v = L"\x1b0u";
-                _autocorrected = true;
-            } else if (!_c1.empty() && _v == L"wo") {
-                _v = L"\x1a1";
-                for (auto& rp : _respos)
-                    if (rp & ResposAutocorrect)
-                        _cases.erase(_cases.begin() + (rp & ResposMask));
-                _autocorrected = true;
-            } else if (_v == L"wuo") {
-                _v = L"\x1b0\x1a1";
+        // see autocorrect_rules
+        uint8_t rewritten = 0;
+        for (auto candidates = autocorrect_rules.Match(_v, _c2); candidates; candidates &= candidates - 1) {
+            const auto& rule = autocorrect_rules[std::countr_zero(candidates)];
+            auto target = uint8_t(1) << static_cast<int>(rule.target);
+            if ((rewritten & target) || (F & rule.required) != rule.required ||
+                (F & rule.excluded) != TypingFlags::Zero || !((rule.tones >> static_cast<int>(_t)) & 1) ||
+                ((rule.conditions & AutocorrectNeedsC1) && _c1.empty()) ||
+                ((rule.conditions & AutocorrectNeedsC2) && _c2.empty()) ||
+                ((rule.conditions & AutocorrectNeedsTransition) && !HasValidRespos())) {
+                continue;
+            }
+            rewritten |= target;
+            if (rule.target == AutocorrectTarget::V) {
+                _v = rule.replacement;
+            } else {
+                _c2 = rule.replacement;
+            }
+            // fixing respos might not be necessary here but fixing cases is
+            switch (rule.cases) {
+            case AutocorrectCases::EraseAutocorrectKeys:
                 for (auto& rp : _respos)
                     if (rp & ResposAutocorrect)
-                        _cases.erase(_cases.begin() + (rp & ResposMask));
-                _autocorrected = true;
-            }
-        }
-        if (!_c1.empty() && _v == L"ie" && !_c2.empty() && (_t == Tones::S || _t == Tones::J)) {
-            _v = L"i\xea";
-            _autocorrected = true;
-        }
-        if (_c2 == L"h" && (_v == L"a" || _v == L"\xea")) {
-            if (_t == Tones::S || _t == Tones::J) {
-                _c2 = L"ch";
+                        _cases.erase(rp & ResposMask);
+                break;
+            case AutocorrectCases::ExtendC2:
                 _cases.push_back(_cases[_c1.length() + _v.length()]);
-                _autocorrected = true;
-            } else if (!IsTypingStyle(TypingFlags::NoAutocorrectTrailingHWithoutTone) || HasValidRespos()) {
-                _c2 = L"nh";
-                _cases.push_back(_cases[_c1.length() + _v.length()]);
-                _autocorrected = true;
-            }
-        }
-        if (HasValidRespos()) {
-            if (_c2 == L"gn") {
-                _c2 = L"ng";
-                _autocorrected = true;
-            } else if (!IsTypingStyle(TypingFlags::NoAutocorrectTrailingG) && _c2 == L"g") {
-                _c2 = L"ng";
-                _cases.push_back(_cases.back());
-                _autocorrected = true;
+                break;
+            default:
+                break;
             }
+            _autocorrected = true;
         }
     }
 
@@ -636,31 +796,30 @@ TelexStates TelexEngine::Commit() {
     }
 
     if (_state == TelexStates::Valid && _v.empty() && _c2.empty() && _config.allow_abbreviations &&
-        std::any_of(_respos.begin(), _respos.end(), [](auto x) { return x & ResposTransitionC1; })) {
+        (_resposSummary & ResposTransitionC1)) {
         _state = TelexStates::Committed;
         return _state;
     }
 
-    if (_state == TelexStates::Valid && DoOptimizeAndAutocorrect() != TelexStates::Valid) {
+    if (_state == TelexStates::Valid && (this->*_specialization->optimizeAndAutocorrect)() != TelexStates::Valid) {
         return _state;
     }
 
     // validate c1
-    auto c1_it = valid_c1.find(_c1);
-    if (c1_it == valid_c1.end()) {
+    if (!syllables.IsValidOnset(syllables.FindOnset(_c1))) {
         _state = TelexStates::CommittedInvalid;
         assert(CheckInvariants());
         return _state;
     }
 
     // validate c2
-    auto c2_it = valid_c2.find(_c2);
-    if (c2_it == valid_c2.end()) {
+    const auto& coda = syllables.GetCoda(syllables.FindCoda(_c2));
+    if (!coda.valid) {
         _state = TelexStates::CommittedInvalid;
         assert(CheckInvariants());
         return _state;
     }
-    if (c2_it->second && !(_t == Tones::S || _t == Tones::J)) {
+    if (coda.restricted && !(_t == Tones::S || _t == Tones::J)) {
         _state = TelexStates::CommittedInvalid;
         assert(CheckInvariants());
         return _state;
@@ -701,8 +860,9 @@ TelexStates TelexEngine::Commit() {
 
 TelexStates TelexEngine::Cancel() {
     if (_backconverted && _c1.size() + _v.size() + _c2.size() != _keyBuffer.size()) {
-        auto s = Peek();
-        _keyBuffer = s;
+        wchar_t buf[MaxOutputLength];
+        auto len = Peek(buf);
+        _keyBuffer = std::wstring_view(buf, len);
         _state = TelexStates::BackconvertFailed;
     } else {
         _state = TelexStates::CommittedInvalid;
@@ -712,37 +872,62 @@ TelexStates TelexEngine::Cancel() {
 }
 
 TelexStates TelexEngine::Backconvert(const std::wstring& s) {
+    return Backconvert(std::wstring_view(s));
+}
+
+TelexStates TelexEngine::Backconvert(std::wstring_view s) {
+    return (this->*_specialization->backconvert)(s);
+}
+
+template <TypingStyles S, TypingFlags F>
+TelexStates TelexEngine::DoBackconvert(std::wstring_view s) {
     assert(_keyBuffer.empty());
     if (!_keyBuffer.empty())
         return _state;
+    // words that don't fit in the key buffer can't be backconverted, and are left with the caller rather than cut short
+    if (s.size() > _keyBuffer.capacity()) {
+        return TelexStates::BackconvertFailed;
+    }
+    if (_state == TelexStates::Valid) {
+        if (BackconvertDirect<S, F>(s)) {
+            if (!_keyBuffer.empty()) {
+                _backconverted = true;
+            }
+            assert(CheckInvariants());
+            return _state;
+        }
+        // start over from the empty word and replay the keys instead
+        _keyBuffer.clear();
+        _respos.clear();
+        Rewind(0);
+    }
+    const auto& table = backconversion_tables[static_cast<size_t>(S)];
     bool found_backconversion = false;
     bool failed = false;
     for (auto c : s) {
         // for emulating double key outcomes ("xoong")
-        auto double_flag = IsTypingStyle(TypingFlags::IsTelex) && _c2.empty() && (_v == L"e" || _v == L"o");
+        auto double_flag = IsTypingStyle<F>(TypingFlags::IsTelex) && _c2.empty() && (_v == L"e" || _v == L"o");
         auto clow = ToLower(c);
-        auto cat = ClassifyCharacter(clow);
+        auto cat = ClassifyCharacter<S>(clow);
         if (cat != CharTypes::Uncategorized) {
             if (double_flag && clow == _v[0])
-                PushChar(c);
-            PushChar(c);
+                DoPushChar<S, F>(c);
+            DoPushChar<S, F>(c);
         } else {
-            auto it = GetTypingStyle()->backconversions.find(clow);
-            if (it != GetTypingStyle()->backconversions.end()) {
-                if (double_flag && it->second[0] == _v[0]) {
-                    if (c != clow) {
-                        // c is upper
-                        PushChar(ToUpper(it->second[0]));
-                    } else {
-                        PushChar(it->second[0]);
-                    }
+            auto d = table.Get(clow);
+            if (d.letter) {
+                if (double_flag && d.base == _v[0]) {
+                    DoPushChar<S, F>(c != clow ? ToUpper(d.base) : d.base);
                 }
-                for (auto backc : it->second) {
+                for (auto backc : {d.base, d.modifier, d.tone}) {
+                    if (!backc) {
+                        continue;
+                    }
                     if (c != clow) {
                         // c is upper
-                        PushChar(ToUpper(backc));
+                        DoPushChar<S, F>(ToUpper(backc));
                     } else {
-                        PushChar(backc);
+                        DoPushChar<S, F>(backc);
                     }
                 }
                 found_backconversion = true;
@@ -766,38 +951,273 @@ TelexStates TelexEngine::Backconvert(const std::wstring& s) {
     return _state;
 }
 
+// lays out a word spelled as one syllable (c1, then vowels with their modifiers and tones, then c2) straight from the
+// decomposition of its characters, producing the same components, respos and snapshots as DoPushChar would for its
+// keys. returns false as soon as a key would take any other path in DoPushChar, in which case the word is replayed
+template <TypingStyles S, TypingFlags F>
+bool TelexEngine::BackconvertDirect(std::wstring_view s) {
+    const auto& table = backconversion_tables[static_cast<size_t>(S)];
+    // untoned characters of _v as spelled by s
+    ComponentBuffer letters;
+
+    auto pushKey = [&](wchar_t k, bool ccase) {
+        if (_keyBuffer.size() >= MaxLength) {
+            return false;
+        }
+        _keyBuffer.push_back(ccase ? ToUpper(k) : k);
+        return true;
+    };
+    // the vowel branch of DoPushChar, for keys that must make a transition or a new character
+    auto pushVowelKey = [&](wchar_t k, bool ccase, bool transition) {
+        if (!pushKey(k, ccase)) {
+            return false;
+        }
+        _v.push_back(k);
+        auto before = _v.size();
+        int offset = 0;
+        auto lastRespos = _keyBuffer.size() > 1 ? _respos.back() : 0;
+        if (lastRespos & ResposTransitionV && k == ToLower(_keyBuffer.rbegin()[1])) {
+            // double key undo
+            return false;
+        }
+        if (TransitionV(GetTypingStyle<S>()->transitions, offset)) {
+            if (IsTypingStyle<F>(TypingFlags::InvalidateOnVowelPostTone) && _toneCount) {
+                return false;
+            }
+            if (transition && _v.size() < before) {
+                PushRespos(static_cast<unsigned int>(_c1.size() + offset) | ResposTransitionV);
+            } else if (!transition && _v.size() == before) {
+                _cases.push_back(ccase);
+                PushRespos(_respos_current++ | ResposTransitionV);
+            } else {
+                return false;
+            }
+        } else if (!transition && IS(ClassifyCharacter<S>(k), CharTypes::Vowel)) {
+            _cases.push_back(ccase);
+            PushRespos(_respos_current++);
+        } else {
+            return false;
+        }
+        SaveUndo();
+        return true;
+    };
+    auto pushToneKey = [&](wchar_t k, bool ccase) {
+        auto cat = ClassifyCharacter<S>(k);
+        if (!IS(cat, CharTypes::Tone) || IS(cat, CharTypes::Vowel | CharTypes::Transition | CharTypes::Dd |
+                                                      CharTypes::UW | CharTypes::OW | CharTypes::W | CharTypes::WA |
+                                                      CharTypes::LeadingW)) {
+            return false;
+        }
+        auto newtone = GetCharTone(cat);
+        if (newtone == _t || (IsTypingStyle<F>(TypingFlags::InvalidateDoubleTone) && _toneCount) ||
+            !pushKey(k, ccase)) {
+            return false;
+        }
+        _t = newtone;
+        _toneCount++;
+        PushRespos(ResposTone);
+        SaveUndo();
+        return true;
+    };
+
+    for (auto c : s) {
+        auto clow = ToLower(c);
+        auto ccase = c != clow;
+        auto d = clow >= L'a' && clow <= L'z' ? CharDecomposition{clow, clow} : table.Get(clow);
+        if (!d.letter) {
+            return false;
+        }
+        auto cat = ClassifyCharacter<S>(d.base);
+
+        if (VowelAlphabet::GetSymbol(d.letter) && !(_v.empty() && _c1 == L"g" && d.letter == L'i')) {
+            // a vowel, taking one key for the new character, then its modifier and tone keys
+            if (!_c2.empty() || IS(cat, CharTypes::Conso | CharTypes::Dd | CharTypes::UW | CharTypes::OW)) {
+                return false;
+            }
+            // the double key emulation of DoBackconvert ("xoong")
+            if (IsTypingStyle<F>(TypingFlags::IsTelex) && (_v == L"e" || _v == L"o") && d.base == _v[0]) {
+                return false;
+            }
+            if (!pushVowelKey(d.base, ccase, false)) {
+                return false;
+            }
+            if (d.modifier) {
+                auto mcat = ClassifyCharacter<S>(d.modifier);
+                if (IS(mcat, CharTypes::Conso | CharTypes::Dd | CharTypes::UW | CharTypes::OW)) {
+                    return false;
+                } else if (IS(mcat, CharTypes::Vowel | CharTypes::Transition)) {
+                    if (!pushVowelKey(d.modifier, ccase, true)) {
+                        return false;
+                    }
+                } else if (IS(mcat, CharTypes::W | CharTypes::WA)) {
+                    if (!pushKey(d.modifier, ccase)) {
+                        return false;
+                    }
+                    int offset = 0;
+                    bool vw_transitioned = false;
+                    if (IS(mcat, CharTypes::W)) {
+                        vw_transitioned = TransitionV(_c1 == L"q" ? transitions_w_q : transitions_w, offset, true);
+                    }
+                    if (!vw_transitioned && IS(mcat, CharTypes::WA)) {
+                        vw_transitioned = TransitionV(_c1 == L"q" ? transitions_wa_q : transitions_wa, offset, true);
+                    }
+                    if (!vw_transitioned) {
+                        return false;
+                    }
+                    PushRespos(static_cast<unsigned int>(_c1.size() + offset) | ResposTransitionW);
+                    SaveUndo();
+                } else {
+                    return false;
+                }
+            }
+            if (d.tone && !pushToneKey(d.tone, ccase)) {
+                return false;
+            }
+            // transitions may have rewritten earlier vowels, which the replay would then have to fix up
+            letters.push_back(d.letter);
+            if (_v != letters) {
+                return false;
+            }
+
+        } else if (_v.empty() && _c2.empty() && _c1 != L"gi") {
+            // c1, where 'i' only follows 'g'
+            if (d.modifier) {
+                // đ, which is only typed as a whole c1
+                if (!_c1.empty() || !IS(cat, CharTypes::ConsoC1) ||
+                    !IS(ClassifyCharacter<S>(d.modifier), CharTypes::Dd) || !pushKey(d.base, ccase)) {
+                    return false;
+                }
+                FeedNewResultChar(_c1, d.base, ccase);
+                SaveUndo();
+                if (!pushKey(d.modifier, ccase)) {
+                    return false;
+                }
+                _c1 = L"\x111";
+                PushRespos(0 | ResposTransitionC1);
+                SaveUndo();
+            } else {
+                if (_c1 == L"g" && d.letter == L'i') {
+                    // 'gi'
+                } else if (_c1.empty()) {
+                    if (!IS(cat, CharTypes::ConsoC1)) {
+                        return false;
+                    }
+                } else if (
+                    IS(cat, CharTypes::Dd) ||
+                    !((_config.allow_abbreviations && IS(cat, CharTypes::ConsoC1)) ||
+                      IS(cat, CharTypes::ConsoContinue))) {
+                    return false;
+                }
+                if (!pushKey(d.base, ccase)) {
+                    return false;
+                }
+                FeedNewResultChar(_c1, d.base, ccase);
+                SaveUndo();
+                if (d.tone && !pushToneKey(d.tone, ccase)) {
+                    return false;
+                }
+            }
+
+        } else {
+            // c2, which needs a vowel or 'gi' before it
+            if (d.modifier || d.tone ||
+                IS(cat, CharTypes::Vowel | CharTypes::Transition | CharTypes::Dd | CharTypes::UW | CharTypes::OW |
+                            CharTypes::W | CharTypes::WA | CharTypes::LeadingW | CharTypes::Tone)) {
+                return false;
+            }
+            if (_c2.empty()) {
+                if (!IS(cat, CharTypes::ConsoC2)) {
+                    return false;
+                }
+                // see the teencode exception in DoPushChar
+                if (_c1 != L"\x111" && _t != Tones::Z && _t != Tones::S && _t != Tones::J &&
+                    syllables.GetCoda(syllables.FindCoda(std::wstring_view(&d.base, 1))).restricted) {
+                    return false;
+                }
+                int offset = 0;
+                if (TransitionV(_c1 == L"q" ? transitions_wv_c2_q : transitions_wv_c2, offset)) {
+                    return false;
+                }
+            } else if (!IS(cat, CharTypes::Conso)) {
+                return false;
+            }
+            if (!pushKey(d.base, ccase)) {
+                return false;
+            }
+            FeedNewResultChar(_c2, d.base, ccase);
+            SaveUndo();
+        }
+    }
+
+    assert(_c1.size() + _v.size() + _c2.size() == s.size());
+    RenderComposition(_composition, true);
+    return true;
+}
+
 std::wstring TelexEngine::Retrieve() const {
+    wchar_t buf[MaxOutputLength];
+    return std::wstring(buf, Retrieve(buf));
+}
+
+std::wstring TelexEngine::RetrieveRaw() const {
+    wchar_t buf[MaxOutputLength];
+    return std::wstring(buf, RetrieveRaw(buf));
+}
+
+std::wstring TelexEngine::Peek() const {
+    wchar_t buf[MaxOutputLength];
+    return std::wstring(buf, Peek(buf));
+}
+
+size_t TelexEngine::Retrieve(std::span<wchar_t> out) const {
     if (_state == TelexStates::Invalid || _state == TelexStates::CommittedInvalid ||
         _state == TelexStates::BackconvertFailed) {
-        return RetrieveRaw();
+        return RetrieveRaw(out);
     }
-    std::wstring result(_c1);
-    result.append(_v);
-    result.append(_c2);
+    ComponentBuffer result;
+    result.append(_c1).append(_v).append(_c2);
     ApplyCases(result, _cases);
-    return result;
+    return CopyOut(out, result);
 }
 
-std::wstring TelexEngine::RetrieveRaw() const {
-    std::wstring result;
-    if (_state != TelexStates::BackconvertFailed) {
-        for (size_t i = 0; i < _keyBuffer.size(); i++)
-            if (!(_respos[i] & ResposDoubleUndo))
-                result.push_back(_keyBuffer[i]);
-    } else {
-        result = _keyBuffer;
+size_t TelexEngine::RetrieveRaw(std::span<wchar_t> out) const {
+    if (_state == TelexStates::BackconvertFailed) {
+        return CopyOut(out, _keyBuffer);
     }
-    return result;
+    assert(_respos.size() <= _keyBuffer.size());
+    size_t len = 0;
+    for (size_t i = 0; i < _respos.size(); i++) {
+        if (!(_respos[i] & ResposDoubleUndo)) {
+            if (len < out.size())
+                out[len] = _keyBuffer[i];
+            len++;
+        }
+    }
+    // passthrough keys are never dropped
+    std::wstring_view passthrough(_keyBuffer);
+    passthrough.remove_prefix(_respos.size());
+    if (len < out.size()) {
+        CopyOut(out.subspan(len), passthrough);
+    }
+    return len + passthrough.size();
 }
 
-std::wstring TelexEngine::Peek() const {
+size_t TelexEngine::Peek(std::span<wchar_t> out) const {
     if (_state == TelexStates::Invalid || _state == TelexStates::CommittedInvalid ||
         _state == TelexStates::BackconvertFailed) {
-        return RetrieveRaw();
+        return RetrieveRaw(out);
     }
 
-    std::wstring result(_c1);
-    result.append(_v);
+    if (_state == TelexStates::Valid) {
+        if (!_composition.found && _t != Tones::Z) {
+            return RetrieveRaw(out);
+        }
+        return CopyOut(out, _composition.text);
+    }
+
+    // committed words are rendered from scratch
+    ComponentBuffer result;
+    result.append(_c1).append(_v);
 
     VInfo vinfo;
     auto found = GetTonePos(false, &vinfo);
@@ -805,9 +1225,9 @@ std::wstring TelexEngine::Peek() const {
         if (_t == Tones::Z) {
             result.append(_c2);
             ApplyCases(result, _cases);
-            return result;
+            return CopyOut(out, result);
         } else {
-            return RetrieveRaw();
+            return RetrieveRaw(out);
         }
     }
 
@@ -824,12 +1244,33 @@ std::wstring TelexEngine::Peek() const {
     result.append(_c2);
     ApplyCases(result, _cases);
 
-    return result;
+    return CopyOut(out, result);
+}
+
+OutputDelta DiffOutput(std::wstring_view previous, std::wstring_view current, std::span<wchar_t> out) {
+    auto prefix = static_cast<size_t>(
+        std::mismatch(current.begin(), current.end(), previous.begin(), previous.end()).first - current.begin());
+    auto maxSuffix = std::min(current.size(), previous.size()) - prefix;
+    auto suffix = static_cast<size_t>(
+        std::mismatch(current.rbegin(), current.rbegin() + maxSuffix, previous.rbegin(), previous.rbegin() + maxSuffix)
+            .first -
+        current.rbegin());
+    auto inserted = current.substr(prefix, current.size() - prefix - suffix);
+    CopyOut(out, inserted);
+    return OutputDelta{prefix, previous.size() - prefix - suffix, inserted.size()};
+}
+
+OutputDelta TelexEngine::PeekDelta(std::wstring_view previous, std::span<wchar_t> out) const {
+    if (_state == TelexStates::Valid && (_composition.found || _t == Tones::Z)) {
+        // what Peek would copy out, diffed in place
+        return DiffOutput(previous, std::wstring_view(_composition.text), out);
+    }
+    wchar_t buf[MaxOutputLength];
+    return DiffOutput(previous, std::wstring_view(buf, std::min(Peek(buf), std::size(buf))), out);
 }
 
 bool TelexEngine::AcceptsChar(wchar_t c) const {
-    const auto& charlist = GetTypingStyle()->charlist;
-    return charlist.find(ToLower(c)) != std::wstring_view::npos;
+    return IsAcceptedChar(_config.typing_style, c);
 }
 
 bool TelexEngine::CheckInvariants() const {
@@ -852,6 +1293,8 @@ bool TelexEngine::CheckInvariants() const {
     // ResposExpunged is not meant to survive beyond Backspace()
     if (std::any_of(_respos.begin(), _respos.end(), [](auto r) { return r & ResposExpunged; }))
         return false;
+    if ((std::accumulate(_respos.begin(), _respos.end(), 0u, std::bit_or<>()) & ResposValidMask) != _resposSummary)
+        return false;
     if (_state == TelexStates::Valid || _state == TelexStates::Invalid) {
         if (_c1.size() + _v.size() + _c2.size() > _keyBuffer.size())
             return false;
@@ -860,6 +1303,20 @@ bool TelexEngine::CheckInvariants() const {
         if (_keyBuffer.size() != _respos.size())
             return false;
     }
+    if (_state == TelexStates::Invalid) {
+        if (_keyBuffer.size() < _respos.size())
+            return false;
+    }
+    if (_state == TelexStates::Valid || _state == TelexStates::Invalid) {
+        if (_undoCount < 1 || _undoCount > std::size(_undo) || _undoCount > _keyBuffer.size() + 1)
+            return false;
+    }
+    if (_state == TelexStates::Valid) {
+        Composition fresh;
+        RenderComposition(fresh, true);
+        if (fresh.text != _composition.text || fresh.found != _composition.found)
+            return false;
+    }
     if (_state == TelexStates::Valid || _state == TelexStates::Committed) {
         if (_c1.size() + _v.size() + _c2.size() != _cases.size())
             return false;
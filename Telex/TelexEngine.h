@@ -6,10 +6,10 @@
 #include <algorithm>
 #include <optional>
 #include <utility>
-#include <vector>
 #include <string>
 #include "Telex.h"
 #include "TelexMaps.h"
+#include "TelexBuffers.h"
 
 namespace VietType {
 namespace Telex {
@@ -131,6 +131,18 @@ constexpr TypingFlags operator~(TypingFlags val) {
 
 constexpr size_t NumOptimizationLevels = 8;
 
+constexpr size_t MaxLength = 10; // enough for "nghieengsz" and "nhuwowngxf"
+// don't let respos overflow into flags
+constexpr size_t MaxRawLength = 250;
+
+// one extra slot for autocorrect lengthening the word (e.g. "ah" -> "anh")
+using ComponentBuffer = FixedString<MaxLength + 1>;
+using KeyBuffer = FixedString<MaxRawLength + 1>;
+using CaseBuffer = FixedBitVector<MaxLength + 1>;
+using ResposBuffer = FixedVector<unsigned int, MaxRawLength + 1>;
+static_assert(std::is_trivially_copyable_v<KeyBuffer> && std::is_trivially_copyable_v<ResposBuffer>);
+static_assert(KeyBuffer::capacity() <= MaxOutputLength && ComponentBuffer::capacity() <= MaxOutputLength);
+
 using TransitionV = std::pair<std::wstring_view, int>;
 
 struct TypingStyle {
@@ -142,11 +154,29 @@ struct TypingStyle {
     unsigned long max_optimize;
 };
 
-class TelexEngine : public ITelexEngine {
+// lookups into the tables of TelexData.h for the rest of the library, see TelexTables.h
+
+wchar_t ToUpper(wchar_t c);
+wchar_t ToLower(wchar_t c);
+bool IsAcceptedChar(TypingStyles style, wchar_t c);
+/// <summary>
+/// whether c is a precomposed letter that style can backconvert
+/// </summary>
+bool IsBackconversionLetter(TypingStyles style, wchar_t c);
+
+/// <summary>
+/// the smallest edit from previous to current, writing the inserted chars into out (truncated like the span overloads
+/// of Peek). takes time proportional to the shorter of the two strings
+/// </summary>
+OutputDelta DiffOutput(std::wstring_view previous, std::wstring_view current, std::span<wchar_t> out);
+
+// the reference ITelexEngine implementation; in-process callers should hold it directly so that calls can be resolved
+// statically, leaving ITelexEngine/TelexNew as the stable interface
+class TelexEngine final : public ITelexEngine {
 public:
     explicit TelexEngine(const TelexConfig& config);
-    TelexEngine(const TelexEngine&) = delete;
-    TelexEngine& operator=(const TelexEngine&) = delete;
+    TelexEngine(const TelexEngine&) = default;
+    TelexEngine& operator=(const TelexEngine&) = default;
     TelexEngine(TelexEngine&&) = default;
     TelexEngine& operator=(TelexEngine&&) = default;
     virtual ~TelexEngine() {
@@ -156,11 +186,18 @@ public:
     void SetConfig(const TelexConfig& config) override;
 
     void Reset() override;
-    TelexStates PushChar(wchar_t c) override;
+    TelexStates PushChar(wchar_t c) override {
+        return (this->*_specialization->pushChar)(c);
+    }
     TelexStates Backspace() override;
     TelexStates Commit() override;
     TelexStates Cancel() override;
     TelexStates Backconvert(const std::wstring& s) override;
+    /// <summary>
+    /// words longer than KeyBuffer::capacity() return BackconvertFailed without touching the engine, which stays empty
+    /// (GetState() is still Valid); the caller keeps the word as it is
+    /// </summary>
+    TelexStates Backconvert(std::wstring_view s);
 
     constexpr TelexStates GetState() const override {
         return _state;
@@ -168,18 +205,45 @@ public:
     std::wstring Retrieve() const override;
     std::wstring RetrieveRaw() const override;
     std::wstring Peek() const override;
+    size_t Retrieve(std::span<wchar_t> out) const;
+    size_t RetrieveRaw(std::span<wchar_t> out) const;
+    size_t Peek(std::span<wchar_t> out) const;
     constexpr std::wstring::size_type Count() const override {
         return _keyBuffer.size();
     }
 
     bool AcceptsChar(wchar_t c) const override;
 
+    size_t RetrieveInto(std::span<wchar_t> out) const override {
+        return Retrieve(out);
+    }
+    size_t RetrieveRawInto(std::span<wchar_t> out) const override {
+        return RetrieveRaw(out);
+    }
+    size_t PeekInto(std::span<wchar_t> out) const override {
+        return Peek(out);
+    }
+    /// <summary>
+    /// valid words are diffed straight from the composition, which is at most MaxLength + 1 chars; other states render
+    /// the raw keys first
+    /// </summary>
+    OutputDelta PeekDelta(std::wstring_view previous, std::span<wchar_t> out) const override;
+
     constexpr Tones GetTone() const {
         return _t;
     }
-    constexpr const std::vector<unsigned int>& GetRespos() const {
+    /// <summary>
+    /// passthrough keys have no entry, see _respos
+    /// </summary>
+    constexpr const ResposBuffer& GetRespos() const {
         return _respos;
     }
+    /// <summary>
+    /// every key of the word, including the ones that RetrieveRaw leaves out (ResposDoubleUndo)
+    /// </summary>
+    constexpr const KeyBuffer& GetKeyBuffer() const {
+        return _keyBuffer;
+    }
     constexpr bool IsBackconverted() const {
         return _backconverted;
     }
@@ -191,23 +255,36 @@ public:
     bool CheckInvariantsBackspace(TelexStates prevState) const;
 
 private:
+    // reads engine state while generating TelexAutomaton
+    friend class AutomatonGenerator;
+
     struct TelexConfig _config;
     TypingFlags _cachedFlags;
+    /// <summary>
+    /// code paths compiled for the current typing style and flags, picked by SetConfig
+    /// </summary>
+    struct Specialization {
+        TypingStyles style;
+        TypingFlags flags;
+        TelexStates (TelexEngine::*pushChar)(wchar_t c);
+        TelexStates (TelexEngine::*optimizeAndAutocorrect)();
+        TelexStates (TelexEngine::*backconvert)(std::wstring_view s);
+    };
+    const Specialization* _specialization = nullptr;
 
     TelexStates _state = TelexStates::Valid;
 
-    std::wstring _keyBuffer;
-    std::wstring _c1;
-    std::wstring _v;
-    std::wstring _c2;
+    KeyBuffer _keyBuffer;
+    ComponentBuffer _c1;
+    ComponentBuffer _v;
+    ComponentBuffer _c2;
     Tones _t = Tones::Z;
     unsigned int _toneCount = 0;
-    // don't use bool vector since that's special cased in the STL
     /// <summary>
     /// only use when valid;
     /// 1 = uppercase, 0 = lowercase
     /// </summary>
-    std::vector<int> _cases;
+    CaseBuffer _cases;
     /// <summary>
     /// for each character in the _keyBuffer, record which output character it's responsible for,
     /// e.g. 'đuống' (dduoongs) _respos = 00122340 (T = tone, C = transition _c1, V = transition _v)
@@ -217,12 +294,60 @@ private:
     /// - 0 is a valid placeholder for respos position (backspacing the last character will reset the engine state
     /// anyway)
     /// - tones use a respos value of 0 since they're committed in a separate phase
+    /// - keys typed into a word that is already invalid are passthrough keys, which only go into _keyBuffer: their
+    /// respos would be their position | ResposInvalidate, so _respos stops at the key that invalidated the word
     /// </summary>
-    std::vector<unsigned int> _respos;
+    ResposBuffer _respos;
     unsigned int _respos_current = 0;
+    /// <summary>
+    /// union of the ResposValidMask transitions in _respos
+    /// </summary>
+    unsigned int _resposSummary = 0;
     bool _backconverted = false;
     bool _autocorrected = false;
 
+    /// <summary>
+    /// engine state right after each keystroke, so that Backspace can rewind instead of replaying the whole word.
+    /// _keyBuffer and _respos are append-only during typing and aren't saved here.
+    /// only keystrokes typed into a valid word get a snapshot, since keys typed after the word became invalid are
+    /// plain appends; _undo[0] is always the empty state
+    /// </summary>
+    struct UndoState {
+        TelexStates state = TelexStates::Valid;
+        Tones t = Tones::Z;
+        unsigned int toneCount = 0;
+        unsigned int respos_current = 0;
+        unsigned int resposSummary = 0;
+        // _c1 + _v + _c2
+        ComponentBuffer chars;
+        unsigned int c1Length = 0;
+        unsigned int vLength = 0;
+        CaseBuffer cases;
+    };
+    // the engine is polymorphic and so not trivially copyable itself, but all of its state is
+    static_assert(std::is_trivially_copyable_v<UndoState>);
+    UndoState _undo[MaxLength + 2];
+    size_t _undoCount = 1;
+
+    /// <summary>
+    /// Peek() output of the valid word, updated as keys are typed so that peeking doesn't redo the tone lookup.
+    /// not kept up to date outside of the Valid state
+    /// </summary>
+    struct Composition {
+        ComponentBuffer text;
+        // _c1 + _v + _c2 that text was rendered from
+        ComponentBuffer source;
+        unsigned int c1Length = 0;
+        unsigned int vLength = 0;
+        Tones t = Tones::Z;
+        // position of the toned character in text, or -1
+        int toneAt = -1;
+        VInfo vinfo{0, C2Mode::Either};
+        bool found = false;
+    };
+    static_assert(std::is_trivially_copyable_v<Composition>);
+    Composition _composition;
+
 private:
     template <bool sorted>
     _Success_(return) bool TransitionV(
@@ -238,18 +363,35 @@ private:
         }
     }
 
+    template <TypingStyles S, TypingFlags F>
+    static constexpr Specialization Specialize();
+    static const Specialization* FindSpecialization(TypingStyles style, TypingFlags flags);
+
     const TypingStyle* GetTypingStyle() const;
-    bool IsTypingStyle(TypingFlags flag) const {
-        return static_cast<unsigned long long>(_cachedFlags & flag);
-    }
-    CharTypes ClassifyCharacter(_In_ wchar_t lc) const;
+    template <TypingStyles S>
+    static const TypingStyle* GetTypingStyle();
+    template <TypingFlags F>
+    bool IsTypingStyle(TypingFlags flag) const;
+    template <TypingStyles S>
+    static CharTypes ClassifyCharacter(_In_ wchar_t lc);
     void Invalidate();
     void InvalidateAndPopBack(wchar_t c);
-    std::optional<std::pair<std::wstring_view, VInfo>> FindTable() const;
+    std::optional<VInfo> FindTable() const;
     bool GetTonePos(_In_ bool predict, _Out_ VInfo* vinfo) const;
     bool HasValidRespos() const;
-    void FeedNewResultChar(std::wstring& target, wchar_t c, bool ccase, unsigned int respos_flags = 0);
+    void PushRespos(unsigned int rp);
+    void FeedNewResultChar(ComponentBuffer& target, wchar_t c, bool ccase, unsigned int respos_flags = 0);
+    void SaveUndo();
+    void Rewind(size_t count);
+    void RenderComposition(Composition& comp, bool full) const;
+    template <TypingStyles S, TypingFlags F>
+    TelexStates DoPushChar(wchar_t c);
+    template <TypingStyles S, TypingFlags F>
     TelexStates DoOptimizeAndAutocorrect();
+    template <TypingStyles S, TypingFlags F>
+    TelexStates DoBackconvert(std::wstring_view s);
+    template <TypingStyles S, TypingFlags F>
+    bool BackconvertDirect(std::wstring_view s);
 };
 
 } // namespace Telex
@@ -8,6 +8,9 @@
 #include <array>
 #include <vector>
 #include <optional>
+#include <string_view>
+#include <type_traits>
+#include <cstdint>
 #include <cassert>
 
 namespace VietType {
@@ -23,6 +26,78 @@ static constexpr bool pair_less(const std::pair<K, V>& a, const KK& b) {
     return a.first < b;
 }
 
+// short keys are packed into integers so that lookups compare words instead of strings.
+// the first character goes to the highest bits, so that integer order matches the order of the keys
+using PackedKey = uint64_t;
+constexpr size_t MaxPackedKeyLength = 4;
+
+constexpr std::optional<PackedKey> PackKey(std::wstring_view key) {
+    if (key.size() > MaxPackedKeyLength) {
+        return std::nullopt;
+    }
+    PackedKey packed = 0;
+    for (size_t i = 0; i < MaxPackedKeyLength; i++) {
+        auto c = i < key.size() ? static_cast<std::make_unsigned_t<wchar_t>>(key[i]) : 0;
+        // zero is the padding
+        if (i < key.size() && (c == 0 || c > 0xffff)) {
+            return std::nullopt;
+        }
+        packed = (packed << 16) | c;
+    }
+    return packed;
+}
+
+constexpr std::optional<PackedKey> PackKey(wchar_t key) {
+    return static_cast<std::make_unsigned_t<wchar_t>>(key);
+}
+
+template <typename K>
+constexpr bool CanPackKeys(const K* keys, size_t size) {
+    return std::all_of(keys, keys + size, [](const auto& k) { return PackKey(k).has_value(); });
+}
+
+template <typename K, typename V>
+constexpr bool CanPackKeys(const std::pair<K, V>* items, size_t size) {
+    return std::all_of(items, items + size, [](const auto& p) { return PackKey(p.first).has_value(); });
+}
+
+// M is either the size of the table, or 0 if the keys of the table can't be packed
+template <size_t M, typename T, size_t N>
+constexpr std::array<PackedKey, M> PackKeys(const std::array<T, N>& items) {
+    std::array<PackedKey, M> packed{};
+    for (size_t i = 0; i < M; i++) {
+        if constexpr (requires { typename T::first_type; }) {
+            packed[i] = *PackKey(items[i].first);
+        } else {
+            packed[i] = *PackKey(items[i]);
+        }
+    }
+    return packed;
+}
+
+// branchless lower_bound: the loop runs log2(size) times whatever the key, and the comparison becomes a cmov
+constexpr size_t PackedLowerBound(const PackedKey* keys, size_t size, PackedKey key) {
+    if (size == 0) {
+        return 0;
+    }
+    const PackedKey* base = keys;
+    while (size > 1) {
+        auto half = size / 2;
+        base = base[half] < key ? base + half : base;
+        size -= half;
+    }
+    return (base - keys) + (*base < key);
+}
+
+// linear scan without early exit, which compilers can vectorize
+constexpr size_t PackedFind(const PackedKey* keys, size_t size, PackedKey key) {
+    size_t found = size;
+    for (size_t i = size; i-- > 0;) {
+        found = keys[i] == key ? i : found;
+    }
+    return found;
+}
+
 #define TM_INHERIT_MEMBER(return_type, var, func)                                                                      \
     constexpr return_type func() const {                                                                               \
         return var.func();                                                                                             \
@@ -68,12 +143,29 @@ public:
             assert(std::is_sorted(_begin, _begin + _size, twopair_less<K, V>));
         }
     }
+    /// <summary>
+    /// packed must hold PackKey() of every key in the same order, or be null to search the keys directly
+    /// </summary>
+    constexpr ArrayMap(const_pointer begin, size_t size, const PackedKey* packed) : ArrayMap(begin, size) {
+        _packed = packed;
+        if constexpr (sorted) {
+            assert(!_packed || std::is_sorted(_packed, _packed + _size));
+        }
+    }
     constexpr ArrayMap(const ArrayMap&) = default;
     constexpr ArrayMap& operator=(const ArrayMap&) = default;
     ~ArrayMap() = default;
 
     template <typename KK>
     constexpr const_iterator find(const KK& key) const {
+        if (_packed) {
+            auto packed = PackKey(K(key));
+            if (!packed) {
+                return this->cend();
+            }
+            auto pos = sorted ? PackedLowerBound(_packed, _size, *packed) : PackedFind(_packed, _size, *packed);
+            return pos < _size && _packed[pos] == *packed ? _begin + pos : this->cend();
+        }
         if constexpr (sorted) {
             auto first = std::lower_bound(this->cbegin(), this->cend(), key, pair_less<K, V, KK>);
             if (first != this->cend() && first->first == key) {
@@ -99,6 +191,7 @@ public:
 private:
     const_pointer _begin = nullptr;
     size_t _size = 0;
+    const PackedKey* _packed = nullptr;
 };
 
 template <typename K, bool sorted = false>
@@ -141,12 +234,29 @@ public:
             assert(std::is_sorted(_begin, _begin + _size));
         }
     }
+    /// <summary>
+    /// packed must hold PackKey() of every key in the same order, or be null to search the keys directly
+    /// </summary>
+    constexpr ArraySet(const_pointer begin, size_t size, const PackedKey* packed) : ArraySet(begin, size) {
+        _packed = packed;
+        if constexpr (sorted) {
+            assert(!_packed || std::is_sorted(_packed, _packed + _size));
+        }
+    }
     constexpr ArraySet(const ArraySet&) = default;
     constexpr ArraySet& operator=(const ArraySet&) = default;
     ~ArraySet() = default;
 
     template <typename KK>
     constexpr const_iterator find(const KK& key) const {
+        if (_packed) {
+            auto packed = PackKey(K(key));
+            if (!packed) {
+                return this->cend();
+            }
+            auto pos = sorted ? PackedLowerBound(_packed, _size, *packed) : PackedFind(_packed, _size, *packed);
+            return pos < _size && _packed[pos] == *packed ? _begin + pos : this->cend();
+        }
         if constexpr (sorted) {
             auto first = std::lower_bound(this->cbegin(), this->cend(), key);
             if (first != this->cend() && *first == key) {
@@ -172,6 +282,156 @@ public:
 private:
     const_pointer _begin = nullptr;
     size_t _size = 0;
+    const PackedKey* _packed = nullptr;
+};
+
+// words of at most 8 ASCII characters packed into an integer, one byte per character
+using PackedWord = uint64_t;
+constexpr size_t MaxPackedWordLength = 8;
+
+/// <summary>
+/// transform is applied to each character before packing; words that are too long or have characters outside of
+/// ASCII after the transform can't be packed
+/// </summary>
+template <typename Transform>
+constexpr std::optional<PackedWord> PackWord(std::wstring_view word, Transform transform) {
+    if (word.size() > MaxPackedWordLength) {
+        return std::nullopt;
+    }
+    PackedWord packed = 0;
+    for (size_t i = 0; i < word.size(); i++) {
+        auto c = static_cast<std::make_unsigned_t<wchar_t>>(transform(word[i]));
+        if (c == 0 || c > 0x7f) {
+            return std::nullopt;
+        }
+        packed |= static_cast<PackedWord>(c) << (i * 8);
+    }
+    return packed;
+}
+
+constexpr std::optional<PackedWord> PackWord(std::wstring_view word) {
+    return PackWord(word, [](wchar_t c) { return c; });
+}
+
+/// <summary>
+/// minimal perfect hash set of packed words, built once from a fixed list of N words (e.g. at compile time).
+/// words are spread into buckets, and each bucket gets a pilot value that sends all of its words to free slots;
+/// membership is then a single probe
+/// </summary>
+template <size_t N>
+class WordSet {
+    static_assert(N > 0);
+
+public:
+    constexpr explicit WordSet(const std::array<std::wstring_view, N>& words) {
+        std::array<PackedWord, N> keys{};
+        std::array<size_t, NumBuckets> bucketSize{};
+        for (size_t i = 0; i < N; i++) {
+            auto packed = PackWord(words[i]);
+            if (!packed) {
+                return;
+            }
+            keys[i] = *packed;
+            bucketSize[GetBucket(Hash(keys[i]))]++;
+        }
+
+        // counting sort of the words by bucket
+        std::array<size_t, NumBuckets + 1> bucketStart{};
+        for (size_t b = 0; b < NumBuckets; b++) {
+            bucketStart[b + 1] = bucketStart[b] + bucketSize[b];
+        }
+        std::array<PackedWord, N> members{};
+        std::array<size_t, NumBuckets> filled{};
+        for (auto key : keys) {
+            auto b = GetBucket(Hash(key));
+            members[bucketStart[b] + filled[b]++] = key;
+        }
+
+        // place the largest buckets first, while there are still plenty of free slots
+        std::array<bool, N> taken{};
+        auto maxSize = *std::max_element(bucketSize.begin(), bucketSize.end());
+        for (auto size = maxSize; size > 0; size--) {
+            for (size_t b = 0; b < NumBuckets; b++) {
+                if (bucketSize[b] == size && !PlaceBucket(b, &members[bucketStart[b]], size, taken)) {
+                    return;
+                }
+            }
+        }
+        _valid = true;
+    }
+
+    /// <summary>
+    /// false if the words couldn't be packed or hashed, in which case nothing is ever found
+    /// </summary>
+    constexpr bool valid() const {
+        return _valid;
+    }
+    static constexpr size_t size() {
+        return N;
+    }
+
+    constexpr bool contains(PackedWord key) const {
+        auto h = Hash(key);
+        return _valid && _slots[GetSlot(h, _pilots[GetBucket(h)])] == key;
+    }
+    constexpr bool contains(std::wstring_view word) const {
+        auto packed = PackWord(word);
+        return packed && contains(*packed);
+    }
+    // the words in no particular order
+    constexpr const PackedWord* begin() const {
+        return _slots.data();
+    }
+    constexpr const PackedWord* end() const {
+        return _slots.data() + N;
+    }
+
+private:
+    // about 2 words per bucket, which keeps the pilot search short enough to run at compile time
+    static constexpr size_t NumBuckets = N / 2 + 1;
+    using pilot_type = uint16_t;
+
+    static constexpr uint64_t Hash(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return x;
+    }
+    static constexpr size_t GetBucket(uint64_t h) {
+        return static_cast<size_t>((h >> 32) % NumBuckets);
+    }
+    static constexpr size_t GetSlot(uint64_t h, pilot_type pilot) {
+        return static_cast<size_t>(Hash(h ^ pilot) % N);
+    }
+
+    constexpr bool PlaceBucket(size_t bucket, const PackedWord* members, size_t size, std::array<bool, N>& taken) {
+        for (uint32_t pilot = 0; pilot <= UINT16_MAX; pilot++) {
+            size_t placed = 0;
+            for (; placed < size; placed++) {
+                auto slot = GetSlot(Hash(members[placed]), static_cast<pilot_type>(pilot));
+                if (taken[slot]) {
+                    break;
+                }
+                taken[slot] = true;
+                _slots[slot] = members[placed];
+            }
+            if (placed == size) {
+                _pilots[bucket] = static_cast<pilot_type>(pilot);
+                return true;
+            }
+            // undo the partial placement
+            for (size_t i = 0; i < placed; i++) {
+                taken[GetSlot(Hash(members[i]), static_cast<pilot_type>(pilot))] = false;
+            }
+        }
+        return false;
+    }
+
+    std::array<PackedWord, N> _slots{};
+    std::array<pilot_type, NumBuckets> _pilots{};
+    bool _valid = false;
 };
 
 #undef TM_INHERIT_MEMBER
@@ -0,0 +1,239 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <cassert>
+#include "TelexEngine.h"
+
+namespace VietType {
+namespace Telex {
+
+// syllable components (c1, v, c2) are interned as nodes of small tries built from the valid_* tables,
+// so that validating a component and finding the tone position of a syllable are a handful of array reads
+
+enum class OnsetClass : uint8_t {
+    Other,
+    Q,
+    Gi,
+};
+
+// which vowel table applies to a syllable, see TelexEngine::FindTable
+enum class NucleusTable : uint8_t {
+    Plain,
+    // no c2 and oa_uy_tone1 off
+    PlainOaUy,
+    Q,
+    Gi,
+    Max,
+};
+
+struct CodaInfo {
+    bool valid = false;
+    // tones are restricted to s/j
+    bool restricted = false;
+};
+
+// letters that may appear in a lowercase c1/c2, 0 for anything else
+struct ConsonantAlphabet {
+    static constexpr unsigned int Size = 19;
+    static constexpr unsigned int GetSymbol(wchar_t c) {
+        switch (c) {
+        case L'b':
+            return 1;
+        case L'c':
+            return 2;
+        case L'd':
+            return 3;
+        case L'g':
+            return 4;
+        case L'h':
+            return 5;
+        // for 'gi'
+        case L'i':
+            return 6;
+        case L'k':
+            return 7;
+        case L'l':
+            return 8;
+        case L'm':
+            return 9;
+        case L'n':
+            return 10;
+        case L'p':
+            return 11;
+        case L'q':
+            return 12;
+        case L'r':
+            return 13;
+        case L's':
+            return 14;
+        case L't':
+            return 15;
+        case L'v':
+            return 16;
+        case L'x':
+            return 17;
+        case L'\x111': // đ
+            return 18;
+        default:
+            return 0;
+        }
+    }
+};
+
+// letters that may appear in a lowercase untoned v, 0 for anything else
+struct VowelAlphabet {
+    static constexpr unsigned int Size = 13;
+    static constexpr unsigned int GetSymbol(wchar_t c) {
+        switch (c) {
+        case L'a':
+            return 1;
+        case L'e':
+            return 2;
+        case L'i':
+            return 3;
+        case L'o':
+            return 4;
+        case L'u':
+            return 5;
+        case L'y':
+            return 6;
+        case L'\xe2': // â
+            return 7;
+        case L'\xea': // ê
+            return 8;
+        case L'\xf4': // ô
+            return 9;
+        case L'\x103': // ă
+            return 10;
+        case L'\x1a1': // ơ
+            return 11;
+        case L'\x1b0': // ư
+            return 12;
+        default:
+            return 0;
+        }
+    }
+};
+
+template <size_t MaxNodes, typename Alphabet>
+class ComponentTrie {
+    static_assert(MaxNodes <= 256);
+
+public:
+    using node_type = uint8_t;
+    // every transition out of the dead node leads back to it
+    static constexpr node_type Dead = 0;
+    static constexpr node_type Root = 1;
+
+    constexpr node_type Step(node_type node, wchar_t c) const {
+        return _next[node][Alphabet::GetSymbol(c)];
+    }
+    constexpr node_type Find(std::wstring_view s) const {
+        node_type node = Root;
+        for (auto c : s) {
+            node = Step(node, c);
+        }
+        return node;
+    }
+    constexpr node_type Insert(std::wstring_view s) {
+        node_type node = Root;
+        for (auto c : s) {
+            auto sym = Alphabet::GetSymbol(c);
+            assert(sym != 0);
+            if (_next[node][sym] == Dead) {
+                assert(_count < MaxNodes);
+                _next[node][sym] = static_cast<node_type>(_count++);
+            }
+            node = _next[node][sym];
+        }
+        return node;
+    }
+    constexpr size_t size() const {
+        return _count;
+    }
+
+private:
+    std::array<std::array<node_type, Alphabet::Size>, MaxNodes> _next{};
+    size_t _count = 2;
+};
+
+class SyllableIndex {
+public:
+    // enough for the valid_* tables, kept tight since the index is built at compile time
+    static constexpr size_t MaxOnsetNodes = 32;
+    static constexpr size_t MaxNucleusNodes = 72;
+    static constexpr size_t MaxCodaNodes = 12;
+    using OnsetTrie = ComponentTrie<MaxOnsetNodes, ConsonantAlphabet>;
+    using NucleusTrie = ComponentTrie<MaxNucleusNodes, VowelAlphabet>;
+    using CodaTrie = ComponentTrie<MaxCodaNodes, ConsonantAlphabet>;
+
+    template <typename C1Set, typename VMap, typename VQMap, typename VGiMap, typename VOaUyMap, typename C2Map>
+    constexpr SyllableIndex(const C1Set& c1, const VMap& v, const VQMap& v_q, const VGiMap& v_gi,
+                            const VOaUyMap& v_oa_uy, const C2Map& c2) {
+        for (const auto& s : c1) {
+            auto node = _onsets.Insert(s);
+            _onsetValid[node] = true;
+            _onsetClass[node] = s == L"q" ? OnsetClass::Q : s == L"gi" ? OnsetClass::Gi : OnsetClass::Other;
+        }
+        for (const auto& [s, vinfo] : v) {
+            auto node = _nuclei.Insert(s);
+            _nucleusInfo[node][static_cast<size_t>(NucleusTable::Plain)] = vinfo;
+            _nucleusInfo[node][static_cast<size_t>(NucleusTable::PlainOaUy)] = vinfo;
+        }
+        for (const auto& [s, vinfo] : v_oa_uy) {
+            _nucleusInfo[_nuclei.Insert(s)][static_cast<size_t>(NucleusTable::PlainOaUy)] = vinfo;
+        }
+        for (const auto& [s, vinfo] : v_q) {
+            _nucleusInfo[_nuclei.Insert(s)][static_cast<size_t>(NucleusTable::Q)] = vinfo;
+        }
+        for (const auto& [s, vinfo] : v_gi) {
+            _nucleusInfo[_nuclei.Insert(s)][static_cast<size_t>(NucleusTable::Gi)] = vinfo;
+        }
+        for (const auto& [s, restricted] : c2) {
+            _codaInfo[_codas.Insert(s)] = CodaInfo{true, restricted};
+        }
+    }
+
+    constexpr OnsetTrie::node_type FindOnset(std::wstring_view s) const {
+        return _onsets.Find(s);
+    }
+    constexpr NucleusTrie::node_type FindNucleus(std::wstring_view s) const {
+        return _nuclei.Find(s);
+    }
+    constexpr CodaTrie::node_type FindCoda(std::wstring_view s) const {
+        return _codas.Find(s);
+    }
+
+    constexpr bool IsValidOnset(OnsetTrie::node_type onset) const {
+        return _onsetValid[onset];
+    }
+    constexpr OnsetClass GetOnsetClass(OnsetTrie::node_type onset) const {
+        return _onsetClass[onset];
+    }
+    constexpr const std::optional<VInfo>& GetNucleus(NucleusTrie::node_type nucleus, NucleusTable table) const {
+        return _nucleusInfo[nucleus][static_cast<size_t>(table)];
+    }
+    constexpr const CodaInfo& GetCoda(CodaTrie::node_type coda) const {
+        return _codaInfo[coda];
+    }
+
+private:
+    OnsetTrie _onsets;
+    std::array<bool, MaxOnsetNodes> _onsetValid{};
+    std::array<OnsetClass, MaxOnsetNodes> _onsetClass{};
+    NucleusTrie _nuclei;
+    // indexed by [nucleus][NucleusTable]
+    std::array<std::array<std::optional<VInfo>, static_cast<size_t>(NucleusTable::Max)>, MaxNucleusNodes>
+        _nucleusInfo{};
+    CodaTrie _codas;
+    std::array<CodaInfo, MaxCodaNodes> _codaInfo{};
+};
+
+} // namespace Telex
+} // namespace VietType
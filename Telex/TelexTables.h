@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <string_view>
+#include "TelexMaps.h"
+#include "TelexEngine.h"
+#include "TelexSyllables.h"
+
+namespace VietType {
+namespace Telex {
+
+// TelexData.h builds its tables at compile time, so it's only included by TelexEngine.cpp to build them once.
+// code elsewhere that needs the tables themselves (the automaton generator, WordLister bench) goes through these;
+// single lookups go through the functions next to TelexEngine
+namespace Tables {
+
+extern const ArrayMap<std::wstring_view, TransitionV, false>& transitions_w;
+extern const ArrayMap<std::wstring_view, TransitionV, false>& transitions_w_q;
+extern const ArrayMap<std::wstring_view, TransitionV, false>& transitions_wa;
+extern const ArrayMap<std::wstring_view, TransitionV, false>& transitions_wa_q;
+extern const ArrayMap<std::wstring_view, TransitionV, false>& transitions_wv_c2;
+extern const ArrayMap<std::wstring_view, TransitionV, false>& transitions_wv_c2_q;
+extern const ArraySet<std::wstring_view, true>& valid_c1;
+extern const ArrayMap<std::wstring_view, VInfo, true>& valid_v;
+extern const ArrayMap<std::wstring_view, VInfo, true>& valid_v_q;
+extern const ArrayMap<std::wstring_view, VInfo, true>& valid_v_gi;
+extern const ArrayMap<std::wstring_view, VInfo, false>& valid_v_oa_uy;
+extern const ArrayMap<std::wstring_view, bool, true>& valid_c2;
+extern const SyllableIndex& syllables;
+extern const ArrayMap<wchar_t, std::wstring_view, true>& backconversions_telex;
+extern const std::array<const TypingStyle, static_cast<size_t>(TypingStyles::Max)>& typing_styles;
+
+// the English word lists as packed words, in no particular order
+extern const std::span<const PackedWord> wlist_en;
+extern const std::span<const PackedWord> wlist_en_2;
+extern const std::span<const PackedWord> wlist_en_ac;
+
+} // namespace Tables
+
+} // namespace Telex
+} // namespace VietType
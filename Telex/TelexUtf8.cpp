@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include "TelexUtf8.h"
+#include "TelexChars.h"
+
+namespace VietType {
+namespace Telex {
+
+static constexpr Utf8Table utf8_table;
+
+size_t EncodeUtf8(std::wstring_view str, std::span<char> out) {
+    size_t length = 0;
+    bool truncated = false;
+    for (size_t i = 0; i < str.size(); i++) {
+        char32_t cp = CharIndex(str[i]);
+        char32_t next = i + 1 < str.size() ? CharIndex(str[i + 1]) : 0;
+        if (sizeof(wchar_t) == 2 && cp >= 0xd800 && cp < 0xdc00 && next >= 0xdc00 && next < 0xe000) {
+            cp = 0x10000 + ((cp - 0xd800) << 10) + (next - 0xdc00);
+            i++;
+        } else if ((cp >= 0xd800 && cp < 0xe000) || cp > 0x10ffff) {
+            // lone surrogates (which would come out as CESU-8) and values that aren't code points
+            cp = 0xfffd;
+        }
+        auto u = utf8_table.Get(cp);
+        if (!truncated && length + u.length <= out.size()) {
+            std::copy_n(u.bytes.begin(), u.length, out.begin() + length);
+        } else {
+            truncated = true;
+        }
+        length += u.length;
+    }
+    return length;
+}
+
+void DecodeUtf8(std::string_view str, std::wstring& out) {
+    for (size_t i = 0; i < str.size();) {
+        auto lead = static_cast<unsigned char>(str[i]);
+        size_t length = lead < 0x80 ? 1 : lead < 0xc2 ? 0 : lead < 0xe0 ? 2 : lead < 0xf0 ? 3 : lead < 0xf5 ? 4 : 0;
+        char32_t cp = length == 1 ? lead : lead & (0x7f >> length);
+        size_t n = 1;
+        for (; n < length && i + n < str.size() && (static_cast<unsigned char>(str[i + n]) & 0xc0) == 0x80; n++) {
+            cp = (cp << 6) | (static_cast<unsigned char>(str[i + n]) & 0x3f);
+        }
+        // overlong 3 and 4 byte forms, surrogates and code points past U+10FFFF
+        if (!length || n < length || (length == 3 && (cp < 0x800 || (cp >= 0xd800 && cp < 0xe000))) ||
+            (length == 4 && (cp < 0x10000 || cp > 0x10ffff))) {
+            out.push_back(L'\xfffd');
+            i += std::max<size_t>(n, 1);
+            continue;
+        }
+        if (sizeof(wchar_t) == 2 && cp >= 0x10000) {
+            out.push_back(static_cast<wchar_t>(0xd800 + ((cp - 0x10000) >> 10)));
+            out.push_back(static_cast<wchar_t>(0xdc00 + ((cp - 0x10000) & 0x3ff)));
+        } else {
+            out.push_back(static_cast<wchar_t>(cp));
+        }
+        i += length;
+    }
+}
+
+Utf8Engine::Utf8Engine(const TelexConfig& config) : _engine(config) {
+}
+
+const TelexConfig& Utf8Engine::GetConfig() const {
+    return _engine.GetConfig();
+}
+
+void Utf8Engine::SetConfig(const TelexConfig& config) {
+    _engine.SetConfig(config);
+}
+
+void Utf8Engine::Reset() {
+    _engine.Reset();
+}
+
+TelexStates Utf8Engine::PushKey(char key) {
+    if (!IsKey(key)) {
+        return TelexStates::TxError;
+    }
+    return _engine.PushChar(static_cast<wchar_t>(key));
+}
+
+TelexStates Utf8Engine::PushKeys(std::string_view keys) {
+    auto state = _engine.GetState();
+    for (auto key : keys) {
+        state = PushKey(key);
+        if (state == TelexStates::TxError) {
+            break;
+        }
+    }
+    return state;
+}
+
+TelexStates Utf8Engine::Backspace() {
+    return _engine.Backspace();
+}
+
+TelexStates Utf8Engine::Commit() {
+    return _engine.Commit();
+}
+
+TelexStates Utf8Engine::Cancel() {
+    return _engine.Cancel();
+}
+
+TelexStates Utf8Engine::GetState() const {
+    return _engine.GetState();
+}
+
+bool Utf8Engine::AcceptsKey(char key) const {
+    return IsKey(key) && _engine.AcceptsChar(static_cast<wchar_t>(key));
+}
+
+std::wstring::size_type Utf8Engine::Count() const {
+    return _engine.Count();
+}
+
+size_t Utf8Engine::Retrieve(std::span<char> out) const {
+    wchar_t buf[MaxOutputLength];
+    auto length = std::min(_engine.Retrieve(buf), std::size(buf));
+    return EncodeUtf8(std::wstring_view(buf, length), out);
+}
+
+size_t Utf8Engine::RetrieveRaw(std::span<char> out) const {
+    wchar_t buf[MaxOutputLength];
+    auto length = std::min(_engine.RetrieveRaw(buf), std::size(buf));
+    return EncodeUtf8(std::wstring_view(buf, length), out);
+}
+
+size_t Utf8Engine::Peek(std::span<char> out) const {
+    wchar_t buf[MaxOutputLength];
+    auto length = std::min(_engine.Peek(buf), std::size(buf));
+    return EncodeUtf8(std::wstring_view(buf, length), out);
+}
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include "Telex.h"
+#include "TelexEngine.h"
+
+namespace VietType {
+namespace Telex {
+
+/// <summary>
+/// writes str as UTF-8 into out and returns the length of the whole encoding, which might be larger than out (in which
+/// case only the characters that fit whole are written). the letters of the typing styles are copied from precomputed
+/// encodings; surrogate pairs are encoded as one code point, and lone surrogates as U+FFFD
+/// </summary>
+size_t EncodeUtf8(std::wstring_view str, std::span<char> out);
+
+/// <summary>
+/// appends the characters of str to out, with U+FFFD in place of invalid sequences
+/// </summary>
+void DecodeUtf8(std::string_view str, std::wstring& out);
+
+/// <summary>
+/// TelexEngine for UTF-8 callers (Linux IME frameworks, text pipelines): keys are ASCII bytes, and the output is
+/// rendered into a stack buffer and encoded into the caller's buffer with EncodeUtf8
+/// </summary>
+class Utf8Engine {
+public:
+    explicit Utf8Engine(const TelexConfig& config);
+
+    const TelexConfig& GetConfig() const;
+    void SetConfig(const TelexConfig& config);
+
+    void Reset();
+    /// <summary>
+    /// bytes outside of ASCII are not keys and return TxError without touching the word
+    /// </summary>
+    TelexStates PushKey(char key);
+    /// <summary>
+    /// stops at the first key that returns TxError
+    /// </summary>
+    TelexStates PushKeys(std::string_view keys);
+    TelexStates Backspace();
+    TelexStates Commit();
+    TelexStates Cancel();
+
+    TelexStates GetState() const;
+    bool AcceptsKey(char key) const;
+    std::wstring::size_type Count() const;
+
+    // same as the ITelexEngine functions, with lengths in bytes
+    size_t Retrieve(std::span<char> out) const;
+    size_t RetrieveRaw(std::span<char> out) const;
+    size_t Peek(std::span<char> out) const;
+
+    constexpr const TelexEngine& GetEngine() const {
+        return _engine;
+    }
+
+private:
+    static constexpr bool IsKey(char key) {
+        return static_cast<unsigned char>(key) < 0x80;
+    }
+
+    TelexEngine _engine;
+};
+
+} // namespace Telex
+} // namespace VietType
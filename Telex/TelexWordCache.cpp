@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include "TelexWordCache.h"
+#include "TelexChars.h"
+
+namespace VietType {
+namespace Telex {
+
+static size_t CopyOut(_Out_ std::span<wchar_t> out, _In_ std::wstring_view str) {
+    std::copy_n(str.begin(), std::min(str.size(), out.size()), out.begin());
+    return str.size();
+}
+
+WordCache::WordCache(const TelexConfig& config, size_t capacity)
+    : _engine(config), _configs{config},
+      _entries(std::bit_ceil(std::max<size_t>(1, (capacity + Ways - 1) / Ways)) * Ways),
+      _hands(_entries.size() / Ways) {
+}
+
+const TelexConfig& WordCache::GetConfig() const {
+    return _configs[_config];
+}
+
+void WordCache::SetConfig(const TelexConfig& config) {
+    _engine.SetConfig(config);
+    auto it = std::find(_configs.begin(), _configs.end(), config);
+    _config = static_cast<uint32_t>(it - _configs.begin());
+    if (it == _configs.end()) {
+        _configs.push_back(config);
+    }
+}
+
+TelexStates WordCache::Type(std::wstring_view keys) {
+    _engine.Reset();
+    for (auto c : keys) {
+        _engine.PushChar(c);
+    }
+    return _engine.Commit();
+}
+
+// keys are lowercase.
+// each character takes its case from the key that added it, which is the key whose respos is the position of the next
+// new character when it's typed (see FeedNewResultChar); positions of transitions and tones are always behind it.
+// autocorrect moves characters around at commit time, so for autocorrected words this finds the key of each character
+// by typing the word again in bit_width(keys.size()) rounds instead: round b types the keys whose (1 + index) has bit b
+// set in uppercase, so a character that comes out in uppercase has bit b set in 1 + its key
+void WordCache::Fill(Entry& entry, std::wstring_view keys) {
+    _engine.Reset();
+    for (auto c : keys) {
+        _engine.PushChar(c);
+    }
+    CaseKeys added;
+    const auto& typed = _engine.GetRespos();
+    for (size_t i = 0; i < typed.size() && added.size() < added.capacity(); i++) {
+        if ((typed[i] & ResposMask) == added.size()) {
+            added.push_back(static_cast<uint8_t>(i + 1));
+        }
+    }
+    entry.state = _engine.Commit();
+    entry.text.clear();
+    entry.caseKeys.clear();
+    entry.dropped = 0;
+    if (entry.state != TelexStates::Committed) {
+        const auto& respos = _engine.GetRespos();
+        for (size_t i = 0; i < keys.size() && i < respos.size(); i++) {
+            if (respos[i] & ResposDoubleUndo) {
+                entry.dropped |= uint32_t(1) << i;
+            }
+        }
+        return;
+    }
+
+    wchar_t buf[MaxOutputLength];
+    entry.text.assign(buf, std::min(_engine.Retrieve(buf), entry.text.capacity()));
+    if (!_engine.IsAutocorrected() && added.size() == entry.text.size()) {
+        entry.caseKeys = added;
+        return;
+    }
+    _statistics.retypes++;
+    entry.caseKeys.resize(entry.text.size());
+    FixedString<MaxKeys> probe;
+    for (size_t bit = 0; keys.size() >> bit; bit++) {
+        probe = keys;
+        for (size_t i = 0; i < probe.size(); i++) {
+            if (((i + 1) >> bit) & 1) {
+                probe[i] = ToUpper(probe[i]);
+            }
+        }
+        [[maybe_unused]] auto state = Type(probe);
+        assert(state == entry.state);
+        auto length = std::min(_engine.Retrieve(buf), std::size(buf));
+        assert(length == entry.text.size());
+        for (size_t i = 0; i < entry.text.size() && i < length; i++) {
+            if (buf[i] != entry.text[i]) {
+                entry.caseKeys[i] |= 1 << bit;
+            }
+        }
+    }
+}
+
+WordCache::Entry& WordCache::Victim(size_t bucket) {
+    auto slots = std::span(_entries).subspan(bucket * Ways, Ways);
+    for (auto& slot : slots) {
+        if (!slot.hash) {
+            return slot;
+        }
+    }
+    auto& hand = _hands[bucket];
+    while (slots[hand].referenced) {
+        slots[hand].referenced = false;
+        hand = (hand + 1) % Ways;
+    }
+    auto& victim = slots[hand];
+    hand = (hand + 1) % Ways;
+    _statistics.evictions++;
+    return victim;
+}
+
+WordCache::Result WordCache::TypeWord(std::wstring_view keys, std::span<wchar_t> out) {
+    if (keys.size() > MaxKeys) {
+        _statistics.misses++;
+        auto state = Type(keys);
+        return Result{state, _engine.Retrieve(out)};
+    }
+
+    FixedString<MaxKeys> lower;
+    uint32_t upper = 0;
+    // FNV-1a, 0 is left for empty slots
+    uint64_t hash = 0xcbf29ce484222325 ^ _config;
+    for (size_t i = 0; i < keys.size(); i++) {
+        auto c = ToLower(keys[i]);
+        if (c != keys[i]) {
+            upper |= uint32_t(1) << i;
+        }
+        lower.push_back(c);
+        hash = (hash ^ CharIndex(c)) * 0x100000001b3;
+    }
+    hash |= 1;
+
+    auto bucket = static_cast<size_t>(hash ^ (hash >> 32)) & (_hands.size() - 1);
+    Entry* entry = nullptr;
+    for (auto& slot : std::span(_entries).subspan(bucket * Ways, Ways)) {
+        if (slot.hash == hash && slot.config == _config && slot.keys == lower) {
+            entry = &slot;
+            break;
+        }
+    }
+    if (entry) {
+        _statistics.hits++;
+        entry->referenced = true;
+    } else {
+        _statistics.misses++;
+        entry = &Victim(bucket);
+        entry->hash = hash;
+        entry->config = _config;
+        entry->referenced = false;
+        entry->keys = lower;
+        Fill(*entry, lower);
+    }
+
+    if (entry->state == TelexStates::Committed) {
+        ComponentBuffer result = entry->text;
+        for (size_t i = 0; i < result.size(); i++) {
+            auto key = entry->caseKeys[i];
+            if (key && ((upper >> (key - 1)) & 1)) {
+                result[i] = ToUpper(result[i]);
+            }
+        }
+        return Result{entry->state, CopyOut(out, result)};
+    }
+    size_t length = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (!((entry->dropped >> i) & 1)) {
+            if (length < out.size()) {
+                out[length] = keys[i];
+            }
+            length++;
+        }
+    }
+    return Result{entry->state, length};
+}
+
+} // namespace Telex
+} // namespace VietType
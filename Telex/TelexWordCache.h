@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "Telex.h"
+#include "TelexBuffers.h"
+#include "TelexEngine.h"
+
+namespace VietType {
+namespace Telex {
+
+/// <summary>
+/// committed words for callers that convert the same words over and over (word list scans, benchmarks, text
+/// conversion). words are looked up by their lowercase keys and the config they were typed with; the engine only uses
+/// the case of a key to pick the case of the characters that it adds, so the cases of the keys are applied to the
+/// cached word afterwards.
+/// the table is set-associative: a word can only go into the Ways slots of its bucket, and a full bucket evicts with
+/// CLOCK
+/// </summary>
+class WordCache {
+public:
+    // longer words bypass the cache
+    static constexpr size_t MaxKeys = 32;
+    static constexpr size_t Ways = 8;
+
+    struct Statistics {
+        size_t hits = 0;
+        // including the words that bypass the cache
+        size_t misses = 0;
+        size_t evictions = 0;
+        // misses on autocorrected words, which are typed again to find the cases of their characters
+        size_t retypes = 0;
+    };
+
+    struct Result {
+        TelexStates state;
+        // full length of the output, which may be longer than the buffer
+        size_t length;
+    };
+
+    /// <summary>
+    /// capacity is in words, rounded up to a power of two number of buckets
+    /// </summary>
+    WordCache(const TelexConfig& config, size_t capacity);
+
+    const TelexConfig& GetConfig() const;
+    /// <summary>
+    /// words cached under the previous configs are kept
+    /// </summary>
+    void SetConfig(const TelexConfig& config);
+
+    /// <summary>
+    /// same as Reset, PushChar of each key and Commit on a TelexEngine; out receives what Retrieve would return
+    /// </summary>
+    Result TypeWord(std::wstring_view keys, std::span<wchar_t> out);
+
+    size_t capacity() const {
+        return _entries.size();
+    }
+    constexpr const Statistics& GetStatistics() const {
+        return _statistics;
+    }
+
+private:
+    using CaseKeys = FixedVector<uint8_t, MaxLength + 1>;
+
+    struct Entry {
+        // 0 if the slot is empty
+        uint64_t hash = 0;
+        uint32_t config = 0;
+        // for CLOCK
+        bool referenced = false;
+        TelexStates state = TelexStates::CommittedInvalid;
+        FixedString<MaxKeys> keys;
+        // lowercase Retrieve() output if the word was committed
+        ComponentBuffer text;
+        // for each character of text, 1 + the key whose case it takes, 0 if it's always lowercase
+        CaseKeys caseKeys;
+        // keys left out of the raw output
+        uint32_t dropped = 0;
+    };
+
+    TelexStates Type(std::wstring_view keys);
+    void Fill(Entry& entry, std::wstring_view keys);
+    Entry& Victim(size_t bucket);
+
+    TelexEngine _engine;
+    // entries refer to their config by index
+    std::vector<TelexConfig> _configs;
+    uint32_t _config = 0;
+    std::vector<Entry> _entries;
+    // CLOCK hand of each bucket
+    std::vector<uint8_t> _hands;
+    Statistics _statistics;
+};
+
+} // namespace Telex
+} // namespace VietType
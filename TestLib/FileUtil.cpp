@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright (c) 2024 Dinh Ngoc Tu
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <algorithm>
+#include <bit>
 #include <fstream>
 #include <stdexcept>
 #include <system_error>
@@ -44,5 +46,41 @@ void FreeFile(void* file) {
     std::free(file);
 }
 
+// also joins surrogate pairs where wchar_t is 32-bit
+static wchar_t* WidenWordList(unsigned char* bytes, size_t units, size_t* length) {
+    auto words = static_cast<wchar_t*>(std::malloc(std::max<size_t>(units, 1) * sizeof(wchar_t)));
+    if (!words) {
+        std::free(bytes);
+        throw std::bad_alloc();
+    }
+    size_t out = 0;
+    for (size_t i = 0; i < units; i++) {
+        char32_t c = bytes[2 * i] | (bytes[2 * i + 1] << 8);
+        if (sizeof(wchar_t) == 4 && c >= 0xd800 && c < 0xdc00 && i + 1 < units) {
+            char32_t low = bytes[2 * i + 2] | (bytes[2 * i + 3] << 8);
+            if (low >= 0xdc00 && low < 0xe000) {
+                c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+                i++;
+            }
+        }
+        words[out++] = static_cast<wchar_t>(c);
+    }
+    std::free(bytes);
+    *length = out;
+    return words;
+}
+
+wchar_t* ReadWordList(const std::filesystem::path& filename, size_t* length) {
+    int64_t fsize;
+    auto bytes = static_cast<unsigned char*>(ReadWholeFile(filename, &fsize));
+    auto units = static_cast<size_t>(fsize) / 2;
+    if constexpr (sizeof(wchar_t) == 2 && std::endian::native == std::endian::little) {
+        *length = units;
+        return reinterpret_cast<wchar_t*>(bytes);
+    } else {
+        return WidenWordList(bytes, units, length);
+    }
+}
+
 } // namespace TestLib
 } // namespace VietType
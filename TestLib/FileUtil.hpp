@@ -11,6 +11,11 @@ namespace TestLib {
 
 void* ReadWholeFile(const std::filesystem::path& filename, int64_t* size);
 void FreeFile(void* file);
+/// <summary>
+/// word lists are NUL-separated UTF-16LE; returns the words in native wchar_t (widened where wchar_t is 32-bit), to be
+/// freed with FreeFile
+/// </summary>
+wchar_t* ReadWordList(const std::filesystem::path& filename, size_t* length);
 
 } // namespace TestLib
 } // namespace VietType
@@ -3,7 +3,7 @@
 
 #include "stdafx.h"
 #include "Context.h"
-#include "Telex.h"
+#include "TelexEngine.h"
 #include "ContextManager.h"
 #include "Compartment.h"
 
@@ -121,7 +121,7 @@ HRESULT Context::Initialize(
     _context = context;
     _displayAtom = displayAttrAtom;
 
-    _engine.reset(Telex::TelexNew(config));
+    _engine = std::make_unique<Telex::TelexEngine>(config);
     _configVersion = configVersion;
 
     hr = _textEditSinkAdvisor.Advise(_context, this);
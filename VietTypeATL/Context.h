@@ -7,7 +7,7 @@
 #include "SinkAdvisor.h"
 #include "EditSession.h"
 #include "KeyTranslator.h"
-#include "Telex.h"
+#include "TelexEngine.h"
 
 namespace VietType {
 
@@ -51,7 +51,7 @@ public:
     ITfContext* GetContext() const {
         return _context;
     }
-    Telex::ITelexEngine* GetEngine() const {
+    Telex::TelexEngine* GetEngine() const {
         return _engine.get();
     }
     bool UpdateConfig(_In_ const Telex::TelexConfig& config, _In_ uint64_t configVersion) {
@@ -183,7 +183,7 @@ private:
     TfGuidAtom _displayAtom = TF_INVALID_GUIDATOM;
     bool _blocked = false;
 
-    std::unique_ptr<Telex::ITelexEngine> _engine;
+    std::unique_ptr<Telex::TelexEngine> _engine;
     uint64_t _configVersion = 0;
     SinkAdvisor<ITfTextEditSink> _textEditSinkAdvisor;
 };
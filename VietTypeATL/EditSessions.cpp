@@ -208,31 +208,37 @@ HRESULT Context::DoEditNextState(
     _In_ bool resetAnyway) {
     HRESULT hr;
 
-    std::wstring str;
+    // room for nonEngineAppend and the null terminator
+    std::array<wchar_t, Telex::MaxOutputLength + 2> str;
+    std::span<wchar_t> strOut(str.data(), Telex::MaxOutputLength);
+    size_t length;
     [[maybe_unused]] auto prevCount = GetEngine()->Count();
     switch (state) {
     case Telex::TelexStates::Valid:
-        str = GetEngine()->Peek();
+        length = GetEngine()->Peek(strOut);
         break;
     case Telex::TelexStates::Invalid:
-        str = GetEngine()->RetrieveRaw();
+        length = GetEngine()->RetrieveRaw(strOut);
         break;
     case Telex::TelexStates::Committed:
-        str = GetEngine()->Retrieve();
+        length = GetEngine()->Retrieve(strOut);
         GetEngine()->Reset();
         break;
     default:
-        str = GetEngine()->RetrieveRaw();
+        length = GetEngine()->RetrieveRaw(strOut);
         GetEngine()->Reset();
         break;
     }
     if (resetAnyway) {
         GetEngine()->Reset();
     }
+    // engine output is bounded by MaxOutputLength, but never index past the buffer
+    length = std::min(length, strOut.size());
 
     if (nonEngineAppend) {
-        str += nonEngineAppend;
+        str[length++] = nonEngineAppend;
     }
+    str[length] = L'\0';
 
     CComPtr<ITfComposition> composition(existingComposition);
     if (newComposition) {
@@ -256,17 +262,17 @@ HRESULT Context::DoEditNextState(
         GetTelexStateName(state),
         prevCount,
         nonEngineAppend ? nonEngineAppend : L'_',
-        str.c_str(),
+        str.data(),
         GetTelexStateName(GetEngine()->GetState()),
         GetEngine()->Count());
 
     // sync the composition state with the supposed string state
-    if (!str.empty()) {
+    if (length) {
         if (!composition) {
             hr = StartCompositionNow(ec, &composition);
             HRESULT_CHECK_RETURN(hr, L"StartCompositionNow failed");
         }
-        hr = SetCompositionText(ec, composition, &str[0], static_cast<LONG>(str.length()));
+        hr = SetCompositionText(ec, composition, str.data(), static_cast<LONG>(length));
         HRESULT_CHECK_RETURN(hr, L"SetCompositionText failed");
     } else if (composition) {
         // EndComposition* will not empty composition text so we have to do it manually
@@ -295,7 +301,7 @@ HRESULT Context::EditKey(
     DBG_DPRINT(L"ec = %ld %s '%c'", ec, GetKeyResult(keyResult), push ? push : L'_');
 
     HRESULT hr;
-    Telex::ITelexEngine* engine = context->GetEngine();
+    Telex::TelexEngine* engine = context->GetEngine();
 
     CComPtr<ITfComposition> composition;
     hr = context->GetComposition(ec, &composition);
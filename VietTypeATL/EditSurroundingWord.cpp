@@ -194,8 +194,9 @@ HRESULT Context::BackconvertWord(
     engine->Reset();
     engine->Backconvert(*word);
 
-    auto displayText = engine->Peek();
-    context->SetCompositionText(ec, composition, displayText.c_str(), static_cast<LONG>(displayText.length()));
+    std::array<wchar_t, Telex::MaxOutputLength> displayText;
+    auto displayLength = std::min(engine->Peek(displayText), displayText.size());
+    context->SetCompositionText(ec, composition, displayText.data(), static_cast<LONG>(displayLength));
 
     if (!push)
         return S_OK;
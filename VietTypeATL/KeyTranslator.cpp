@@ -54,7 +54,7 @@ static _Success_(return) _Check_return_ bool IsKeyChar(
 }
 
 KeyResult ClassifyKey(
-    _In_ Telex::ITelexEngine* engine,
+    _In_ const Telex::TelexEngine* engine,
     _In_ WPARAM wParam,
     _In_ LPARAM lParam,
     _In_reads_(256) const BYTE* keyState,
@@ -4,7 +4,7 @@
 #pragma once
 
 #include "Common.h"
-#include "Telex.h"
+#include "TelexEngine.h"
 
 namespace VietType {
 
@@ -27,7 +27,7 @@ enum class KeyResult {
 PCWSTR GetKeyResult(KeyResult keyResult);
 
 KeyResult ClassifyKey(
-    _In_ Telex::ITelexEngine* engine,
+    _In_ const Telex::TelexEngine* engine,
     _In_ WPARAM wParam,
     _In_ LPARAM lParam,
     _In_reads_(256) const BYTE* keyState,
@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <cstdlib>
+#include <new>
+#include <string_view>
+#include "Util.h"
+#include "TelexEngine.h"
+
+using namespace VietType::Telex;
+
+static thread_local size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    allocations++;
+    if (auto p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace VietType {
+namespace UnitTests {
+
+TEST_CASE("TestAllocations", "[alloc]") {
+    TelexConfig config{
+        .typing_style = GENERATE(TypingStyles::Telex, TypingStyles::Vni, TypingStyles::TelexComplicated),
+        .backspaced_word_stays_invalid = GENERATE(true, false),
+        .autocorrect = GENERATE(true, false),
+        .optimize_multilang = static_cast<unsigned long>(GENERATE(0, 3)),
+    };
+    TelexEngine engine(config);
+
+    static constexpr std::wstring_view words[] = {
+        L"nghieengsz",
+        L"nhuwowngxf",
+        L"DDuwowngf",
+        L"ddaay",
+        L"khongoo",
+        L"nwuocs",
+        L"miesgn",
+        L"vieetj9",
+        L"nguo72i",
+        L"supercalifragilisticexpialidocious",
+    };
+
+    SECTION("push char") {
+        wchar_t buf[MaxOutputLength];
+        auto before = allocations;
+        for (auto word : words) {
+            engine.Reset();
+            for (auto c : word) {
+                engine.PushChar(c);
+                engine.Peek(buf);
+            }
+            engine.Commit();
+            engine.Retrieve(buf);
+            engine.RetrieveRaw(buf);
+        }
+        CHECK(allocations == before);
+    }
+
+    SECTION("backspace") {
+        auto before = allocations;
+        for (auto word : words) {
+            engine.Reset();
+            for (auto c : word) {
+                engine.PushChar(c);
+            }
+            while (engine.Count()) {
+                engine.Backspace();
+            }
+        }
+        CHECK(allocations == before);
+    }
+
+    SECTION("backconvert") {
+        auto before = allocations;
+        static constexpr std::wstring_view vwords[] = {
+            L"\x111\x1b0\x1eddng",
+            L"nghi\xeang",
+            L"xoong",
+            L"\x110\x1ecaNH",
+            L"\x111\x63",
+            L"g\xec",
+            L"\x111\x1ed3nw",
+        };
+        for (auto word : vwords) {
+            engine.Reset();
+            engine.Backconvert(word);
+            while (engine.Count()) {
+                engine.Backspace();
+            }
+        }
+        CHECK(allocations == before);
+    }
+}
+
+} // namespace UnitTests
+} // namespace VietType
@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <string_view>
+#include "Util.h"
+#include "TelexEngine.h"
+#include "TelexAutomaton.h"
+
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+static void CheckSameOutput(const TelexEngine& reference, const TelexAutomatonEngine& engine) {
+    AssertTelexStatesEqual(reference.GetState(), engine.GetState());
+    CHECK(reference.Peek() == engine.Peek());
+    CHECK(reference.Retrieve() == engine.Retrieve());
+    CHECK(reference.RetrieveRaw() == engine.RetrieveRaw());
+    CHECK(reference.Count() == engine.Count());
+}
+
+TEST_CASE("TestAutomaton", "[automaton]") {
+    TelexConfig config{
+        .typing_style = GENERATE(TypingStyles::Telex, TypingStyles::Vni),
+        .autocorrect = GENERATE(true, false),
+    };
+    // small enough that the longer words leave the automaton and get handed to TelexEngine
+    auto automaton = TelexAutomaton::Generate(config, 1 << 14);
+    TelexEngine reference(config);
+    TelexAutomatonEngine engine(automaton);
+
+    static constexpr std::wstring_view words[] = {
+        L"aa",
+        L"Aa",
+        L"ddaay",
+        L"DDaay",
+        L"d9a6y",
+        L"nghieengsz",
+        L"nhuwowngxf",
+        L"DDuwowngf",
+        L"khongoo",
+        L"nwuocs",
+        L"miesgn",
+        L"vieetj9",
+        L"nguo72i",
+        L"ass",
+        L"hello",
+        L"supercalifragilisticexpialidocious",
+    };
+
+    SECTION("push char") {
+        for (auto word : words) {
+            reference.Reset();
+            engine.Reset();
+            for (auto c : word) {
+                reference.PushChar(c);
+                engine.PushChar(c);
+                CheckSameOutput(reference, engine);
+            }
+            reference.Commit();
+            engine.Commit();
+            CheckSameOutput(reference, engine);
+        }
+    }
+
+    SECTION("backspace") {
+        for (auto word : words) {
+            reference.Reset();
+            engine.Reset();
+            for (auto c : word) {
+                reference.PushChar(c);
+                engine.PushChar(c);
+            }
+            while (reference.Count()) {
+                reference.Backspace();
+                engine.Backspace();
+                CheckSameOutput(reference, engine);
+            }
+        }
+    }
+
+    SECTION("short words stay in the automaton") {
+        engine.Reset();
+        std::wstring_view word = config.typing_style == TypingStyles::Telex ? L"Aan" : L"A6n";
+        for (auto c : word) {
+            engine.PushChar(c);
+        }
+        CHECK(!engine.IsDelegated());
+        engine.Commit();
+        CHECK(!engine.IsDelegated());
+        CHECK(engine.Retrieve() == L"\xc2n");
+    }
+}
+
+} // namespace UnitTests
+} // namespace VietType
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Util.h"
+#include "TelexEngine.h"
+#include "TelexBatch.h"
+
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+TEST_CASE("TestBatch", "[automaton]") {
+    TelexConfig config{
+        .typing_style = GENERATE(TypingStyles::Telex, TypingStyles::Vni),
+        .autocorrect = GENERATE(true, false),
+    };
+    auto automaton = TelexAutomaton::Generate(config, 1 << 14);
+    TelexEngine reference(config);
+    BatchTyper batch(automaton);
+
+    static constexpr std::wstring_view words[] = {
+        L"",
+        L"aa",
+        L"Aa",
+        L"ddaay",
+        L"DDaay",
+        L"d9a6y",
+        L"nghieengsz",
+        L"NGHIEENGSZ",
+        L"nhuwowngxf",
+        L"DDuwowngf",
+        L"khongoo",
+        L"xooong",
+        L"nwuocs",
+        L"miesgn",
+        L"vieetj9",
+        L"nguo72i",
+        L"ass",
+        L"Hello",
+        L"[",
+        L"supercalifragilisticexpialidocious",
+        L"SUPERCALIFRAGILISTICEXPIALIDOCIOUSANDTHENSOME",
+    };
+
+    PackedWords input;
+    for (auto word : words) {
+        input.push_back(word);
+    }
+    std::vector<TelexStates> states;
+    PackedWords outputs;
+    batch.TypeWords(input, states, outputs);
+
+    REQUIRE(states.size() == std::size(words));
+    REQUIRE(outputs.size() == std::size(words));
+    for (size_t i = 0; i < std::size(words); i++) {
+        reference.Reset();
+        for (auto c : words[i]) {
+            reference.PushChar(c);
+        }
+        AssertTelexStatesEqual(reference.Commit(), states[i]);
+        CHECK(reference.Retrieve() == outputs[i]);
+    }
+    // the automaton is too small for the longest words
+    CHECK(batch.GetDelegatedCount() > 0);
+    CHECK(batch.GetDelegatedCount() < std::size(words));
+}
+
+} // namespace UnitTests
+} // namespace VietType
@@ -0,0 +1,173 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <string>
+#include <string_view>
+#include "Util.h"
+#include "TelexEngine.h"
+#include "TelexConverter.h"
+#include "TelexUtf8.h"
+
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+static std::wstring ConvertWhole(TextConverter& converter, std::wstring_view text) {
+    std::wstring out;
+    converter.Convert(text, out);
+    converter.Flush(out);
+    return out;
+}
+
+TEST_CASE("TestConverter", "[converter]") {
+    TelexConfig config{};
+
+    SECTION("words and breaking characters") {
+        TextConverter converter(config);
+        CHECK(ConvertWhole(converter, L"Vieejt Nam, ddaay laf hello!") == L"Vi\x1ec7t Nam, \x111\xe2y l\xe0 hello!");
+        CHECK(ConvertWhole(converter, L"  \n") == L"  \n");
+        CHECK(ConvertWhole(converter, L"") == L"");
+        // non-ASCII characters break words
+        CHECK(ConvertWhole(converter, L"\x111\x61\x61y") == L"\x111\xe2y");
+    }
+
+    SECTION("same as the engine") {
+        TextConverter converter(config);
+        TelexEngine engine(config);
+        for (auto word : {L"nghieengsz", L"nhuwowngxf", L"DDuwowngf", L"ass", L"Hello", L"khongoo"}) {
+            engine.Reset();
+            for (auto c : std::wstring_view(word)) {
+                engine.PushChar(c);
+            }
+            engine.Commit();
+            CHECK(ConvertWhole(converter, word) == engine.Retrieve());
+        }
+    }
+
+    SECTION("cache statistics") {
+        TextConverter converter(config);
+        CHECK(
+            ConvertWhole(converter, L"ddaay laf ddaay, Ddaay hello") ==
+            L"\x111\xe2y l\xe0 \x111\xe2y, \x110\xe2y hello");
+        // words are cached by their lowercase keys
+        CHECK(converter.GetStatistics().misses == 3);
+        CHECK(converter.GetStatistics().hits == 2);
+        CHECK(converter.GetStatistics().retypes == 0);
+    }
+
+    SECTION("uncached") {
+        std::wstring_view text = L"Tieengs Vieejt, tieengs Anh. nguwowif ddaay laf hello";
+        TextConverter cached(config);
+        TextConverter uncached(config, 0);
+        CHECK(ConvertWhole(uncached, text) == ConvertWhole(cached, text));
+        CHECK(uncached.GetStatistics().hits == 0);
+        CHECK(uncached.GetStatistics().misses == 8);
+        CHECK(cached.GetStatistics().hits == 1);
+        CHECK(cached.GetStatistics().misses == 7);
+    }
+
+    SECTION("pieces") {
+        std::wstring_view text = L"Tieengs Vieejt, tieengs Anh. nguwowif";
+        TextConverter whole(config);
+        auto expected = ConvertWhole(whole, text);
+        for (size_t split = 0; split <= text.size(); split++) {
+            TextConverter converter(config);
+            std::wstring out;
+            converter.Convert(text.substr(0, split), out);
+            converter.Convert(text.substr(split), out);
+            converter.Flush(out);
+            CHECK(out == expected);
+        }
+    }
+
+    SECTION("long runs") {
+        TextConverter converter(config);
+        std::wstring run(MaxRawLength + 1, L'a');
+        CHECK(ConvertWhole(converter, run + L" ddaay") == run + L" \x111\xe2y");
+    }
+
+    SECTION("vni") {
+        config.typing_style = TypingStyles::Vni;
+        TextConverter converter(config);
+        CHECK(ConvertWhole(converter, L"Vie65t Nam 2024") == L"Vi\x1ec7t Nam 2024");
+    }
+
+    SECTION("non-bmp passthrough") {
+        // U+1F600 between words, a surrogate pair with 16-bit wchar_t
+        std::wstring text;
+        DecodeUtf8("Vieejt\xf0\x9f\x98\x80" "ddaay \xf0\x9f\x98\x80!", text);
+        for (size_t split = 0; split <= text.size(); split++) {
+            TextConverter converter(config);
+            std::wstring out;
+            converter.Convert(std::wstring_view(text).substr(0, split), out);
+            converter.Convert(std::wstring_view(text).substr(split), out);
+            converter.Flush(out);
+            std::string utf8(EncodeUtf8(out, {}), '\0');
+            EncodeUtf8(out, utf8);
+            CHECK(utf8 == "Vi\xe1\xbb\x87t\xf0\x9f\x98\x80\xc4\x91\xc3\xa2y \xf0\x9f\x98\x80!");
+        }
+
+        TextBackconverter back(config);
+        std::wstring keys;
+        std::vector<BackconvertFailure> failures;
+        text.clear();
+        DecodeUtf8("Vi\xe1\xbb\x87t\xf0\x9f\x98\x80\xc4\x91\xc3\xa2y", text);
+        back.Convert(text, keys, failures);
+        back.Flush(keys, failures);
+        CHECK(failures.empty());
+        std::string utf8(EncodeUtf8(keys, {}), '\0');
+        EncodeUtf8(keys, utf8);
+        CHECK(utf8 == "Vieejt\xf0\x9f\x98\x80" "ddaay");
+    }
+}
+
+TEST_CASE("TestBackconverter", "[converter]") {
+    TelexConfig config{};
+
+    SECTION("words and failures") {
+        TextBackconverter converter(config, 100);
+        std::wstring out;
+        std::vector<BackconvertFailure> failures;
+        converter.Convert(L"Vi\x1ec7t Nam, \x111\xe2y l\xe0 ba\x301 \x111\x1b0\x1eddngg!", out, failures);
+        converter.Flush(out, failures);
+        // the combining accent breaks the word
+        CHECK(out == L"Vieejt Nam, ddaay laf ba\x301 \x111\x1b0\x1eddngg!");
+        REQUIRE(failures.size() == 1);
+        CHECK(failures[0].offset == 100 + 21);
+        CHECK(failures[0].length == 6);
+        AssertTelexStatesEqual(TelexStates::CommittedInvalid, failures[0].state);
+    }
+
+    SECTION("double keys") {
+        TextBackconverter converter(config);
+        std::wstring out;
+        std::vector<BackconvertFailure> failures;
+        converter.Convert(L"xoong", out, failures);
+        converter.Flush(out, failures);
+        CHECK(failures.empty());
+        TextConverter retype(config);
+        CHECK(ConvertWhole(retype, out) == L"xoong");
+    }
+
+    SECTION("round trip") {
+        std::wstring_view text = L"Ti\x1ebfng Vi\x1ec7t, \x111\x1b0\x1eddng ph\x1ed1. qu\x1ed1\x63 ng\x1eef";
+        for (auto style : {TypingStyles::Telex, TypingStyles::Vni, TypingStyles::TelexComplicated}) {
+            config.typing_style = style;
+            for (size_t split = 0; split <= text.size(); split += 3) {
+                TextBackconverter converter(config);
+                std::wstring keys;
+                std::vector<BackconvertFailure> failures;
+                converter.Convert(text.substr(0, split), keys, failures);
+                converter.Convert(text.substr(split), keys, failures);
+                converter.Flush(keys, failures);
+                CHECK(failures.empty());
+                TextConverter retype(config);
+                CHECK(ConvertWhole(retype, keys) == text);
+            }
+        }
+    }
+}
+
+} // namespace UnitTests
+} // namespace VietType
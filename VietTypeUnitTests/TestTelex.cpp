@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "Util.h"
+#include "TelexEngine.h"
 
 using namespace VietType::Telex;
 
@@ -44,6 +45,63 @@ TEST_CASE("TestTelex", "[telex]") {
         CHECK(std::size_t{0} == engine->Count());
     }
 
+    SECTION("output buffer") {
+        FeedWord(*engine, L"dduwowngf");
+        wchar_t buf[4]{};
+        CHECK(std::size_t{5} == engine->Peek(std::span<wchar_t>()));
+        CHECK(std::size_t{5} == engine->Peek(buf));
+        CHECK(std::wstring_view(buf, std::size(buf)) == L"\x111\x1b0\x1eddn");
+        AssertTelexStatesEqual(TelexStates::Committed, engine->Commit());
+        CHECK(std::size_t{5} == engine->Retrieve(buf));
+        CHECK(std::size_t{9} == engine->RetrieveRaw(buf));
+        CHECK(std::wstring_view(buf, std::size(buf)) == L"dduw");
+    }
+
+    SECTION("peek delta") {
+        std::wstring previous;
+        wchar_t buf[MaxOutputLength];
+        auto Step = [&](OutputDelta expected, std::wstring_view expectedText) {
+            auto delta = engine->PeekDelta(previous, buf);
+            CHECK(expected.offset == delta.offset);
+            CHECK(expected.removed == delta.removed);
+            CHECK(expected.inserted == delta.inserted);
+            CHECK(expectedText == std::wstring_view(buf, delta.inserted));
+            previous.replace(delta.offset, delta.removed, buf, delta.inserted);
+            CHECK(previous == engine->Peek());
+        };
+        FeedWord(*engine, L"tuo");
+        Step({0, 0, 3}, L"tuo");
+        engine->PushChar(L'w');
+        Step({2, 1, 1}, L"\x1a1");
+        engine->PushChar(L'n');
+        Step({1, 2, 3}, L"\x1b0\x1a1n");
+        engine->PushChar(L'g');
+        Step({4, 0, 1}, L"g");
+        engine->PushChar(L'f');
+        Step({2, 1, 1}, L"\x1edd");
+        engine->Backspace();
+        Step({4, 1, 0}, L"");
+        Step({4, 0, 0}, L"");
+
+        // an out too small for the change gets the first chars of it, the count is still the full one
+        wchar_t small[2] = {L'!', L'!'};
+        auto delta = engine->PeekDelta(L"", std::span(small, 1));
+        CHECK(delta.offset == 0);
+        CHECK(delta.removed == 0);
+        CHECK(delta.inserted == 4);
+        CHECK(small[0] == L't');
+        CHECK(small[1] == L'!');
+        delta = engine->PeekDelta(L"tuo", std::span(small, 0));
+        CHECK(delta.offset == 1);
+        CHECK(delta.removed == 2);
+        CHECK(delta.inserted == 3);
+
+        // invalid words go through the raw keys
+        AssertTelexStatesEqual(TelexStates::Invalid, FeedWord(*engine, L"tuowngf:"));
+        previous = L"t\x1b0\x1eddng";
+        Step({1, 4, 7}, L"uowngf:");
+    }
+
     SECTION("push char") {
         SECTION("TestTelexEmptyPushCharC1_1") {
             engine->Reset();
@@ -403,6 +461,25 @@ TEST_CASE("TestTelex", "[telex]") {
                 CHECK(L"ass" == e->Peek());
             }
         }
+
+        SECTION("TestTelexBackspaceLongInvalid") {
+            std::wstring word = L"ddaay://example.com/index.html";
+            AssertTelexStatesEqual(TelexStates::Invalid, FeedWord(*engine, word.c_str()));
+            CHECK(word == engine->Peek());
+            while (word.size() > 6) {
+                word.pop_back();
+                AssertTelexStatesEqual(TelexStates::Invalid, engine->Backspace());
+                CHECK(word == engine->Peek());
+                CHECK(word == engine->RetrieveRaw());
+            }
+            if (config.backspaced_word_stays_invalid) {
+                AssertTelexStatesEqual(TelexStates::Invalid, engine->Backspace());
+                CHECK(L"ddaay" == engine->Peek());
+            } else {
+                AssertTelexStatesEqual(TelexStates::Valid, engine->Backspace());
+                CHECK(L"\x111\xe2y" == engine->Peek());
+            }
+        }
     }
 
     SECTION("test tone and w movements") {
@@ -450,6 +527,33 @@ TEST_CASE("TestTelex", "[telex]") {
                 CHECK(L"" == engine->Peek());
             }
         }
+
+        SECTION("TestTelexBackspaceRewindMatchesReplay") {
+            // backspace rewinds to a snapshot, which must be the same as typing the keys that are left from scratch
+            TelexEngine e(config);
+            TelexEngine fresh(config);
+            for (auto word : {L"truwowngf", L"nguwowif", L"dduwowcj", L"cuwocs", L"cuocws", L"cuwsoc", L"thuowngr",
+                              L"huowng", L"tieengs", L"nghieengsz", L"ddoongf", L"xoongf", L"tuyeetj", L"quaays",
+                              L"gif", L"tosan", L"muaf", L"Uoongs", L"DDuwowngf", L"owf"}) {
+                FeedWord(e, word);
+                while (e.GetState() == TelexStates::Valid && e.Count()) {
+                    AssertTelexStatesEqual(TelexStates::Valid, e.Backspace());
+                    fresh.Reset();
+                    for (auto c : e.GetKeyBuffer()) {
+                        fresh.PushChar(c);
+                    }
+                    AssertTelexStatesEqual(fresh.GetState(), e.GetState());
+                    CHECK(fresh.Peek() == e.Peek());
+                    CHECK(fresh.RetrieveRaw() == e.RetrieveRaw());
+                    CHECK(fresh.GetTone() == e.GetTone());
+                    CHECK(std::equal(
+                        fresh.GetRespos().begin(),
+                        fresh.GetRespos().end(),
+                        e.GetRespos().begin(),
+                        e.GetRespos().end()));
+                }
+            }
+        }
     }
 
     SECTION("test backconversions") {
@@ -469,6 +573,16 @@ TEST_CASE("TestTelex", "[telex]") {
             AssertTelexStatesEqual(TelexStates::Invalid, engine->Backconvert(L"virus"));
             CHECK(L"virus" == engine->Peek());
         }
+        SECTION("TestTelexBackconversionTooLong") {
+            std::wstring word(300, L'a');
+            AssertTelexStatesEqual(TelexStates::BackconvertFailed, engine->Backconvert(word));
+            // nothing is cut short, the word is left to the caller
+            AssertTelexStatesEqual(TelexStates::Valid, engine->GetState());
+            CHECK(engine->Count() == 0);
+            CHECK(L"" == engine->Peek());
+            CHECK(L"" == engine->RetrieveRaw());
+            AssertTelexStatesEqual(TelexStates::Valid, FeedWord(*engine, L"ddaay"));
+        }
         SECTION("TestTelexBackconversionDdoonfCtrlW") {
             AssertTelexStatesEqual(TelexStates::BackconvertFailed, engine->Backconvert(L"\x111\x1ed3nw"));
             CHECK(L"\x111\x1ed3nw" == engine->Peek());
@@ -545,6 +659,16 @@ TEST_CASE("TestTelex", "[telex]") {
         }
     }
 
+    SECTION("test oa/oe/uy config change") {
+        FeedWord(*engine, L"hoaf");
+        auto newConfig = config;
+        newConfig.oa_uy_tone1 = !config.oa_uy_tone1;
+        engine->SetConfig(newConfig);
+        CHECK((newConfig.oa_uy_tone1 ? L"ho\xe0" : L"h\xf2\x61") == engine->Peek());
+        engine->Backspace();
+        CHECK((newConfig.oa_uy_tone1 ? L"ho" : L"h\xf2") == engine->Peek());
+    }
+
     SECTION("test doublekey backspace") {
         SECTION("TestTelexBackspaceMooo") {
             FeedWord(*engine, L"mooo");
@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <string_view>
+#include "Util.h"
+#include "TelexEngine.h"
+#include "TelexUtf8.h"
+
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+static std::string_view Retrieve(const Utf8Engine& engine, std::span<char> buf) {
+    return std::string_view(buf.data(), engine.Retrieve(buf));
+}
+
+TEST_CASE("TestUtf8", "[utf8]") {
+    TelexConfig config{};
+    Utf8Engine engine(config);
+    char buf[MaxOutputLength * 4];
+
+    SECTION("valid words") {
+        engine.PushKeys("DDaay");
+        CHECK(engine.Commit() == TelexStates::Committed);
+        CHECK(Retrieve(engine, buf) == "\xc4\x90\xc3\xa2y");
+
+        engine.Reset();
+        engine.PushKeys("nguwowif");
+        engine.Commit();
+        CHECK(Retrieve(engine, buf) == "ng\xc6\xb0\xe1\xbb\x9di");
+
+        engine.Reset();
+        engine.PushKeys("Vieejt");
+        char peek[16];
+        CHECK(std::string_view(peek, engine.Peek(peek)) == "Vi\xe1\xbb\x87t");
+    }
+
+    SECTION("invalid words") {
+        engine.PushKeys("hello");
+        CHECK(engine.Commit() == TelexStates::CommittedInvalid);
+        CHECK(Retrieve(engine, buf) == "hello");
+        CHECK(std::string_view(buf, engine.RetrieveRaw(buf)) == "hello");
+    }
+
+    SECTION("non-ascii bytes") {
+        CHECK(engine.PushKeys("a\xc3\xa2") == TelexStates::TxError);
+        CHECK(engine.Count() == 1);
+        CHECK(!engine.AcceptsKey('\xc3'));
+    }
+
+    SECTION("truncation") {
+        engine.PushKeys("ddaay");
+        engine.Commit();
+        // "đ" doesn't fit in one byte, and isn't cut in half
+        char small[3] = {'!', '!', '!'};
+        CHECK(engine.Retrieve(std::span(small, 1)) == 5);
+        CHECK(small[0] == '!');
+        CHECK(engine.Retrieve(std::span(small, 3)) == 5);
+        CHECK(std::string_view(small, 3) == "\xc4\x91!");
+    }
+
+    SECTION("encode") {
+        CHECK(EncodeUtf8(L"a\xe0\x1ef9", buf) == 6);
+        CHECK(std::string_view(buf, 6) == "a\xc3\xa0\xe1\xbb\xb9");
+        // outside of the precomputed ranges
+        CHECK(EncodeUtf8(L"\x20ac", buf) == 3);
+        CHECK(std::string_view(buf, 3) == "\xe2\x82\xac");
+    }
+
+    SECTION("non-bmp") {
+        // U+1F600 as written by DecodeUtf8: a surrogate pair with 16-bit wchar_t, one character otherwise
+        std::wstring emoji;
+        DecodeUtf8("\xf0\x9f\x98\x80", emoji);
+        CHECK(emoji.size() == (sizeof(wchar_t) == 2 ? 2 : 1));
+        CHECK(EncodeUtf8(L"a" + emoji + L"b", buf) == 6);
+        CHECK(std::string_view(buf, 6) == "a\xf0\x9f\x98\x80" "b");
+        // not cut in half by truncation
+        char small[4] = {'!', '!', '!', '!'};
+        CHECK(EncodeUtf8(emoji, std::span(small, 3)) == 4);
+        CHECK(std::string_view(small, 4) == "!!!!");
+
+        // surrogates out of order or on their own; with 32-bit wchar_t even a pair isn't valid
+        const wchar_t high = static_cast<wchar_t>(0xd83d), low = static_cast<wchar_t>(0xde00);
+        const wchar_t lone[] = {high, L'a', low, low, high};
+        CHECK(EncodeUtf8(std::wstring_view(lone, std::size(lone)), buf) == 13);
+        CHECK(std::string_view(buf, 13) == "\xef\xbf\xbd" "a\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd");
+        const wchar_t pair[] = {high, low};
+        if (sizeof(wchar_t) == 2) {
+            CHECK(EncodeUtf8(std::wstring_view(pair, 2), buf) == 4);
+            CHECK(std::string_view(buf, 4) == "\xf0\x9f\x98\x80");
+        } else {
+            CHECK(EncodeUtf8(std::wstring_view(pair, 2), buf) == 6);
+            CHECK(std::string_view(buf, 6) == "\xef\xbf\xbd\xef\xbf\xbd");
+        }
+    }
+
+    SECTION("decode") {
+        std::wstring out;
+        DecodeUtf8("\xc4\x91\xc3\xa2y \xe2\x82\xac", out);
+        CHECK(out == L"\x111\xe2y \x20ac");
+        out.clear();
+        // stray continuation, truncated sequence, overlong form
+        DecodeUtf8("\x80" "a\xc4" "b\xe0\x80\x80", out);
+        CHECK(out == L"\xfffd" L"a\xfffd" L"b\xfffd");
+    }
+}
+
+} // namespace UnitTests
+} // namespace VietType
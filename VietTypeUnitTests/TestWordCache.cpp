@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <string_view>
+#include "Util.h"
+#include "TelexEngine.h"
+#include "TelexWordCache.h"
+
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+static void CheckSameWord(TelexEngine& reference, WordCache& cache, std::wstring_view word) {
+    wchar_t buf[MaxOutputLength];
+    auto result = cache.TypeWord(word, buf);
+    reference.Reset();
+    for (auto c : word) {
+        reference.PushChar(c);
+    }
+    AssertTelexStatesEqual(reference.Commit(), result.state);
+    CHECK(reference.Retrieve() == std::wstring_view(buf, result.length));
+}
+
+TEST_CASE("TestWordCache", "[cache]") {
+    TelexConfig config{
+        .typing_style = GENERATE(TypingStyles::Telex, TypingStyles::Vni, TypingStyles::TelexComplicated),
+        .autocorrect = GENERATE(true, false),
+    };
+    TelexEngine reference(config);
+
+    // the same words in different cases share their entries
+    static constexpr std::wstring_view words[] = {
+        L"ddaay",
+        L"DDaay",
+        L"Ddaay",
+        L"dDAAY",
+        L"d9a6y",
+        L"D9A6Y",
+        L"nghieengsz",
+        L"NGHIEENGSZ",
+        L"nhuwowngxf",
+        L"NhuwOwngxf",
+        L"DDuwowngf",
+        L"nwuocs",
+        L"NWUOCS",
+        L"miesgn",
+        L"Miesgn",
+        L"vieetj9",
+        L"nguo72i",
+        L"ass",
+        L"ASS",
+        L"Hello",
+        L"[",
+        L"{",
+        L"",
+        L"supercalifragilisticexpialidocious",
+        L"SUPERCALIFRAGILISTICEXPIALIDOCIOUS",
+    };
+
+    SECTION("hits") {
+        WordCache cache(config, 1024);
+        for (auto word : words) {
+            CheckSameWord(reference, cache, word);
+        }
+        auto misses = cache.GetStatistics().misses;
+        for (auto word : words) {
+            CheckSameWord(reference, cache, word);
+        }
+        CHECK(cache.GetStatistics().misses == misses + 2);
+        CHECK(cache.GetStatistics().hits == std::size(words) * 2 - misses - 2);
+        CHECK(cache.GetStatistics().evictions == 0);
+        // the cases come from the respos of a single typing pass unless autocorrect moved characters around
+        if (!config.autocorrect) {
+            CHECK(cache.GetStatistics().retypes == 0);
+        }
+    }
+
+    SECTION("evictions") {
+        WordCache cache(config, 1);
+        CHECK(cache.capacity() == WordCache::Ways);
+        for (auto i = 0; i < 2; i++) {
+            for (auto word : words) {
+                CheckSameWord(reference, cache, word);
+            }
+        }
+        CHECK(cache.GetStatistics().evictions > 0);
+    }
+
+    SECTION("config") {
+        WordCache cache(config, 1024);
+        auto other = config;
+        other.typing_style = config.typing_style == TypingStyles::Vni ? TypingStyles::Telex : TypingStyles::Vni;
+        TelexEngine otherReference(other);
+        for (auto word : words) {
+            CheckSameWord(reference, cache, word);
+        }
+        cache.SetConfig(other);
+        for (auto word : words) {
+            CheckSameWord(otherReference, cache, word);
+        }
+        cache.SetConfig(config);
+        auto misses = cache.GetStatistics().misses;
+        for (auto word : words) {
+            CheckSameWord(reference, cache, word);
+        }
+        CHECK(cache.GetStatistics().misses == misses + 2);
+    }
+}
+
+} // namespace UnitTests
+} // namespace VietType
@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <filesystem>
+#include <algorithm>
 #include "Telex.h"
 #include "WordListIterator.hpp"
 #include "FileUtil.hpp"
@@ -16,15 +17,12 @@ namespace VietType {
 namespace UnitTests {
 
 TEST_CASE("TestWordList", "[wordlist]") {
-    int64_t fsize = 0;
+    size_t length = 0;
     std::filesystem::path path = std::filesystem::path("../data/vw39kw.txt");
 
-    if (sizeof(wchar_t) != 2)
-        SKIP("VietTypeUnitTests assumes 16-bit wchar_t");
-
-    auto words_ptr = std::unique_ptr<void, decltype(FreeFile)*>{ReadWholeFile(path, &fsize), FreeFile};
+    auto words_ptr = std::unique_ptr<void, decltype(FreeFile)*>{ReadWordList(path, &length), FreeFile};
     auto words = static_cast<const wchar_t*>(words_ptr.get());
-    auto wend = words + fsize / sizeof(wchar_t);
+    auto wend = words + length;
 
     SECTION("TestBackconvertWordList") {
         TelexConfig config1{};
@@ -58,6 +56,42 @@ TEST_CASE("TestWordList", "[wordlist]") {
             CHECK((word == c1 || word == c2));
         }
     }
+
+    SECTION("TestBackconvertMatchesKeysWordList") {
+        // a backconverted word must end up in the same state as typing out its keys
+        for (auto style : {TypingStyles::Telex, TypingStyles::Vni}) {
+            TelexConfig config{};
+            config.typing_style = style;
+            TelexEngine engine1(config);
+            TelexEngine engine2(config);
+
+            for (WordListIterator w(words, wend); w != wend; w++) {
+                if (!w.wlen())
+                    continue;
+                std::wstring word(*w, w.wlen());
+
+                engine1.Reset();
+                if (engine1.Backconvert(word) != TelexStates::Valid)
+                    continue;
+                // RetrieveRaw leaves out the extra keys of double key words like "xoong"
+                if (std::ranges::any_of(engine1.GetRespos(), [](auto rp) { return rp & ResposDoubleUndo; }))
+                    continue;
+                engine2.Reset();
+                for (auto c : engine1.RetrieveRaw())
+                    engine2.PushChar(c);
+
+                CHECK(engine2.GetState() == TelexStates::Valid);
+                CHECK(engine1.Peek() == engine2.Peek());
+                CHECK(engine1.GetTone() == engine2.GetTone());
+                CHECK(std::ranges::equal(engine1.GetRespos(), engine2.GetRespos()));
+
+                engine1.Backspace();
+                engine2.Backspace();
+                CHECK(engine1.Peek() == engine2.Peek());
+                CHECK(std::ranges::equal(engine1.GetRespos(), engine2.GetRespos()));
+            }
+        }
+    }
 }
 
 } // namespace UnitTests
@@ -9,6 +9,22 @@ using namespace VietType::Telex;
 namespace VietType {
 namespace UnitTests {
 
+// check the caller-buffer overloads against the std::wstring ones
+static std::wstring PeekBuffer(ITelexEngine& e) {
+    wchar_t buf[MaxOutputLength];
+    return std::wstring(buf, e.Peek(buf));
+}
+
+static std::wstring RetrieveBuffer(ITelexEngine& e) {
+    wchar_t buf[MaxOutputLength];
+    return std::wstring(buf, e.Retrieve(buf));
+}
+
+static std::wstring RetrieveRawBuffer(ITelexEngine& e) {
+    wchar_t buf[MaxOutputLength];
+    return std::wstring(buf, e.RetrieveRaw(buf));
+}
+
 TelexStates FeedWord(ITelexEngine& e, const wchar_t* input) {
     e.Reset();
     for (auto c : std::wstring(input)) {
@@ -23,8 +39,10 @@ void TestValidWord(ITelexEngine& e, const wchar_t* expected, const wchar_t* inpu
         AssertTelexStatesEqual(TelexStates::Valid, e.PushChar(c));
     }
     CHECK(std::wstring(expected) == e.Peek());
+    CHECK(std::wstring(expected) == PeekBuffer(e));
     AssertTelexStatesEqual(TelexStates::Committed, e.Commit());
     CHECK(std::wstring(expected) == e.Retrieve());
+    CHECK(std::wstring(expected) == RetrieveBuffer(e));
 }
 
 void TestInvalidWord(ITelexEngine& e, const wchar_t* expected, const wchar_t* input) {
@@ -34,11 +52,13 @@ void TestInvalidWord(ITelexEngine& e, const wchar_t* expected, const wchar_t* in
     }
     AssertTelexStatesEqual(TelexStates::CommittedInvalid, e.Commit());
     CHECK(std::wstring(expected) == e.RetrieveRaw());
+    CHECK(std::wstring(expected) == RetrieveRawBuffer(e));
 }
 
 void TestPeekWord(ITelexEngine& e, const wchar_t* expected, const wchar_t* input) {
     FeedWord(e, input);
     CHECK(std::wstring(expected) == e.Peek());
+    CHECK(std::wstring(expected) == PeekBuffer(e));
 }
 
 } // namespace UnitTests
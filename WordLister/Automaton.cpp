@@ -0,0 +1,179 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include "Telex.h"
+#include "WordListIterator.hpp"
+#include "FileUtil.hpp"
+#include "TelexEngine.h"
+#include "TelexAutomaton.h"
+#include "FuzzTables.h"
+
+using namespace VietType::Telex;
+using namespace VietType::TestLib;
+
+// generation keeps every state that can still make a syllable
+static constexpr size_t max_states = 1 << 24;
+// every key sequence up to this length is checked for each config; fuzz goes further with TelexEngine alone
+static constexpr int fuzz_len = 5;
+
+static bool SameOutput(const ITelexEngine& a, const ITelexEngine& b) {
+    return a.GetState() == b.GetState() && a.Peek() == b.Peek() && a.Retrieve() == b.Retrieve() &&
+           a.RetrieveRaw() == b.RetrieveRaw() && a.Count() == b.Count();
+}
+
+// runs TelexEngine and TelexAutomatonEngine side by side
+class AutomatonChecker {
+public:
+    explicit AutomatonChecker(std::shared_ptr<const TelexAutomaton> automaton)
+        : _reference(automaton->GetConfig()), _automaton(automaton) {
+    }
+
+    /// <summary>
+    /// compares the engines after every key, after backspacing the word and after committing it
+    /// </summary>
+    bool Check(std::wstring_view keys) {
+        _reference.Reset();
+        _automaton.Reset();
+        auto same = SameOutput(_reference, _automaton);
+        for (auto c : keys) {
+            _reference.PushChar(c);
+            _automaton.PushChar(c);
+            same = same && SameOutput(_reference, _automaton);
+        }
+        words++;
+        delegated += _automaton.IsDelegated();
+
+        TelexEngine reference(_reference);
+        TelexAutomatonEngine automaton(_automaton);
+        reference.Backspace();
+        automaton.Backspace();
+        same = same && SameOutput(reference, automaton);
+
+        _reference.Commit();
+        _automaton.Commit();
+        same = same && SameOutput(_reference, _automaton);
+        if (!same) {
+            mismatches++;
+            wprintf(L"word mismatch: %ls\n", std::wstring(keys).c_str());
+        }
+        return same;
+    }
+
+    size_t words = 0;
+    size_t mismatches = 0;
+    // words that left the automaton
+    size_t delegated = 0;
+
+private:
+    TelexEngine _reference;
+    TelexAutomatonEngine _automaton;
+};
+
+static void CheckFuzz(std::wstring_view table, int len, int first, AutomatonChecker* checker) {
+    size_t max = 1;
+    for (auto i = 1; i < len; i++) {
+        max *= table.size();
+    }
+    std::wstring keys(len, L'\0');
+    keys[0] = table[first];
+    for (size_t i = 0; i < max; i++) {
+        size_t cur = i;
+        for (auto j = 1; j < len; j++) {
+            keys[j] = table[cur % table.size()];
+            cur /= table.size();
+        }
+        checker->Check(keys);
+    }
+}
+
+bool automaton() {
+    std::vector<std::wstring> ewords;
+    {
+        size_t elength;
+        auto epath = std::filesystem::path("..") / ".." / "data" / "ewdsw.txt";
+        auto ewbuf = ReadWordList(epath, &elength);
+        auto ewend = ewbuf + elength;
+        for (WordListIterator ew(ewbuf, ewend); ew != ewend; ew++) {
+            ewords.emplace_back(*ew, ew.wlen());
+        }
+        FreeFile(ewbuf);
+    }
+    std::vector<std::wstring> vwords;
+    {
+        size_t vlength;
+        auto vpath = std::filesystem::path("..") / ".." / "data" / "vw39kw.txt";
+        auto vwbuf = ReadWordList(vpath, &vlength);
+        auto vwend = vwbuf + vlength;
+        for (WordListIterator vw(vwbuf, vwend); vw != vwend; vw++) {
+            vwords.emplace_back(*vw, vw.wlen());
+        }
+        FreeFile(vwbuf);
+    }
+
+    size_t mismatches = 0;
+    for (auto [style, table] : {std::make_pair(TypingStyles::Telex, table_telex),
+                                std::make_pair(TypingStyles::Vni, table_vni),
+                                std::make_pair(TypingStyles::TelexComplicated, table_telex_complicated)}) {
+        for (int level = 0; level <= 3; level++) {
+            for (int autocorrect = 0; autocorrect <= 1; autocorrect++) {
+                TelexConfig config;
+                config.optimize_multilang = level;
+                config.autocorrect = !!autocorrect;
+                config.typing_style = style;
+                auto t1 = std::chrono::high_resolution_clock::now();
+                auto automaton = TelexAutomaton::Generate(config, max_states);
+                auto t2 = std::chrono::high_resolution_clock::now();
+
+                AutomatonChecker checker(automaton);
+                for (const auto& eword : ewords) {
+                    checker.Check(eword);
+                }
+                // type the Vietnamese words with the keys that backconversion finds for them
+                TelexEngine keyfinder(config);
+                for (const auto& vword : vwords) {
+                    keyfinder.Reset();
+                    if (keyfinder.Backconvert(vword) == TelexStates::Valid) {
+                        checker.Check(keyfinder.RetrieveRaw());
+                    }
+                }
+                auto listWords = checker.words;
+                auto listDelegated = checker.delegated;
+
+                std::vector<AutomatonChecker> checkers(table.size(), AutomatonChecker(automaton));
+                {
+                    std::vector<std::jthread> workers;
+                    for (int first = 0; first < (int)table.size(); first++) {
+                        workers.emplace_back([&, first] {
+                            for (auto len = 1; len <= fuzz_len; len++) {
+                                CheckFuzz(table, len, first, &checkers[first]);
+                            }
+                        });
+                    }
+                }
+                for (const auto& c : checkers) {
+                    checker.words += c.words;
+                    checker.mismatches += c.mismatches;
+                    checker.delegated += c.delegated;
+                }
+
+                wprintf(
+                    L"style %d level %d autocorrect %d: states = %zu, generation time = %llu ms, "
+                    L"word lists = %zu/%zu in automaton, total = %zu/%zu in automaton, mismatches = %zu\n",
+                    (int)style,
+                    level,
+                    autocorrect,
+                    automaton->size(),
+                    static_cast<unsigned long long>(
+                        std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count()),
+                    listWords - listDelegated,
+                    listWords,
+                    checker.words - checker.delegated,
+                    checker.words,
+                    checker.mismatches);
+                mismatches += checker.mismatches;
+            }
+        }
+    }
+    return !mismatches;
+}
@@ -4,6 +4,9 @@
 #include "stdafx.h"
 #include "Telex.h"
 #include "TelexEngine.h"
+#include "TelexTables.h"
+#include "TelexWordCache.h"
+#include "TelexBatch.h"
 #include "WordListIterator.hpp"
 #include "FileUtil.hpp"
 
@@ -13,19 +16,79 @@ using namespace VietType::TestLib;
 #ifdef _DEBUG
 #define EITERATIONS 10
 #define VITERATIONS 200
+#define MITERATIONS 10000
+#define BATCH_STATES (1 << 16)
 #else
 #define EITERATIONS 100
 #define VITERATIONS 2000
+#define MITERATIONS 100000
+#define BATCH_STATES (1 << 20)
 #endif
 
+// each typing style runs its own specialization of the engine
+static constexpr std::pair<TypingStyles, const wchar_t*> styles[] = {
+    {TypingStyles::Telex, L"telex"},
+    {TypingStyles::Vni, L"vni"},
+    {TypingStyles::TelexComplicated, L"telex-complicated"},
+};
+
+static std::wstring MissingKey(std::wstring_view key) {
+    return std::wstring(key) + L'g';
+}
+
+static wchar_t MissingKey(wchar_t key) {
+    return key + 1;
+}
+
+// looks up every key of a table and a near miss of it, through the packed keys and through a plain copy of the table
+// that does the lower_bound (or find_if) over the original keys
+template <typename Map>
+static void BenchMap(const wchar_t* name, const Map& map) {
+    auto keyOf = [](const auto& item) {
+        if constexpr (requires { item.first; }) {
+            return item.first;
+        } else {
+            return item;
+        }
+    };
+    using Key = decltype(keyOf(*map.begin()));
+    using Query = std::conditional_t<std::is_same_v<Key, std::wstring_view>, std::wstring, Key>;
+    std::vector<Query> queries;
+    for (const auto& item : map) {
+        queries.push_back(Query(keyOf(item)));
+        queries.push_back(MissingKey(keyOf(item)));
+    }
+
+    const Map plain(map.data(), map.size());
+    for (auto [m, kind] : {std::make_pair(&map, L"packed"), std::make_pair(&plain, L"plain")}) {
+        size_t hits = 0;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (auto i = 0; i < MITERATIONS; i++) {
+            for (const auto& q : queries) {
+                hits += m->find(q) != m->end();
+            }
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        wprintf(
+            L"%ls %ls lookups total iters: %d, hits = %zu, time = %llu us\n",
+            name,
+            kind,
+            MITERATIONS,
+            hits,
+            static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()));
+    }
+}
+
 bool bench() {
-    {
-        int64_t efsize;
+    for (auto [style, name] : styles) {
+        size_t elength;
         auto epath = std::filesystem::path("..") / ".." / "data" / "ewdsw.txt";
-        auto ewords = static_cast<wchar_t*>(ReadWholeFile(epath, &efsize));
-        auto ewend = ewords + efsize / sizeof(wchar_t);
+        auto ewords = ReadWordList(epath, &elength);
+        auto ewend = ewords + elength;
         TelexConfig config;
+        config.typing_style = style;
         TelexEngine engine(config);
+        wchar_t outbuf[MaxOutputLength];
         unsigned long long count = 0;
         auto t1 = std::chrono::high_resolution_clock::now();
         for (auto i = 0; i < EITERATIONS; i++) {
@@ -34,28 +97,121 @@ bool bench() {
                 engine.Reset();
                 for (auto c : eword) {
                     engine.PushChar(c);
-                    engine.Peek();
+                    engine.Peek(outbuf);
                 }
                 engine.Commit();
-                engine.Retrieve();
+                engine.Retrieve(outbuf);
+                count++;
+            }
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        wprintf(
+            L"%ls ewords total iters: %d, count = %llu, time = %llu us\n",
+            name,
+            EITERATIONS,
+            count,
+            static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()));
+        FreeFile(ewords);
+    }
+
+    // same as above without the peeks, through a WordCache big enough for the whole list
+    for (auto [style, name] : styles) {
+        size_t elength;
+        auto epath = std::filesystem::path("..") / ".." / "data" / "ewdsw.txt";
+        auto ewords = ReadWordList(epath, &elength);
+        auto ewend = ewords + elength;
+        TelexConfig config;
+        config.typing_style = style;
+        WordCache cache(config, 1 << 16);
+        wchar_t outbuf[MaxOutputLength];
+        unsigned long long count = 0;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (auto i = 0; i < EITERATIONS; i++) {
+            for (WordListIterator ew(ewords, ewend); ew != ewend; ew++) {
+                cache.TypeWord(std::wstring_view(*ew, ew.wlen()), outbuf);
                 count++;
             }
         }
         auto t2 = std::chrono::high_resolution_clock::now();
+        const auto& stats = cache.GetStatistics();
         wprintf(
-            L"ewords total iters: %d, count = %llu, time = %llu us\n",
+            L"%ls ewords cached total iters: %d, count = %llu, hits = %zu, misses = %zu, evictions = %zu, retypes = %zu, "
+            L"time = %llu us\n",
+            name,
             EITERATIONS,
             count,
+            stats.hits,
+            stats.misses,
+            stats.evictions,
+            stats.retypes,
             static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()));
         FreeFile(ewords);
     }
 
-    {
-        int64_t vfsize;
+    // same as above without the peeks, word by word through TelexEngine and as one batch through a TelexAutomaton
+    for (auto [style, name] : styles) {
+        size_t elength;
+        auto epath = std::filesystem::path("..") / ".." / "data" / "ewdsw.txt";
+        auto ewords = ReadWordList(epath, &elength);
+        auto ewend = ewords + elength;
+        PackedWords words;
+        for (WordListIterator ew(ewords, ewend); ew != ewend; ew++) {
+            words.push_back(std::wstring_view(*ew, ew.wlen()));
+        }
+        FreeFile(ewords);
+        TelexConfig config;
+        config.typing_style = style;
+
+        TelexEngine engine(config);
+        std::vector<TelexStates> scalarStates(words.size());
+        PackedWords scalarOutputs;
+        wchar_t outbuf[MaxOutputLength];
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (auto i = 0; i < EITERATIONS; i++) {
+            scalarOutputs.clear();
+            for (size_t w = 0; w < words.size(); w++) {
+                engine.Reset();
+                for (auto c : words[w]) {
+                    engine.PushChar(c);
+                }
+                scalarStates[w] = engine.Commit();
+                scalarOutputs.push_back(std::wstring_view(outbuf, engine.Retrieve(outbuf)));
+            }
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+
+        BatchTyper batch(TelexAutomaton::Generate(config, BATCH_STATES));
+        std::vector<TelexStates> states;
+        PackedWords outputs;
+        auto t3 = std::chrono::high_resolution_clock::now();
+        for (auto i = 0; i < EITERATIONS; i++) {
+            batch.TypeWords(words, states, outputs);
+        }
+        auto t4 = std::chrono::high_resolution_clock::now();
+
+        size_t mismatches = 0;
+        for (size_t w = 0; w < words.size(); w++) {
+            mismatches += states[w] != scalarStates[w] || outputs[w] != scalarOutputs[w];
+        }
+        wprintf(
+            L"%ls ewords batch total iters: %d, count = %zu, delegated = %zu, mismatches = %zu, scalar time = %llu us, "
+            L"batch time = %llu us\n",
+            name,
+            EITERATIONS,
+            words.size(),
+            batch.GetDelegatedCount(),
+            mismatches,
+            static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()),
+            static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count()));
+    }
+
+    for (auto [style, name] : styles) {
+        size_t vlength;
         auto vpath = std::filesystem::path("../../data/vw39kw.txt");
-        auto vwords = static_cast<wchar_t*>(ReadWholeFile(vpath, &vfsize));
-        auto vwend = vwords + vfsize / sizeof(wchar_t);
+        auto vwords = ReadWordList(vpath, &vlength);
+        auto vwend = vwords + vlength;
         TelexConfig config;
+        config.typing_style = style;
         TelexEngine engine(config);
         unsigned long long count = 0;
         auto t1 = std::chrono::high_resolution_clock::now();
@@ -69,11 +225,17 @@ bool bench() {
         }
         auto t2 = std::chrono::high_resolution_clock::now();
         wprintf(
-            L"vwords total iters: %d, count = %llu, time = %llu us\n",
+            L"%ls vwords total iters: %d, count = %llu, time = %llu us\n",
+            name,
             VITERATIONS,
             count,
             static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()));
         FreeFile(vwords);
     }
+
+    BenchMap(L"valid_v", Tables::valid_v);
+    BenchMap(L"valid_c1", Tables::valid_c1);
+    BenchMap(L"transitions_w", Tables::transitions_w);
+    BenchMap(L"backconversions_telex", Tables::backconversions_telex);
     return true;
 }
@@ -0,0 +1,234 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <fstream>
+#include "Telex.h"
+#include "TelexConverter.h"
+#include "TelexUtf8.h"
+#include "FileUtil.hpp"
+
+using namespace VietType::Telex;
+using namespace VietType::TestLib;
+
+static constexpr std::pair<TypingStyles, const wchar_t*> styles[] = {
+    {TypingStyles::Telex, L"telex"},
+    {TypingStyles::Vni, L"vni"},
+    {TypingStyles::TelexComplicated, L"telex-complicated"},
+};
+
+// text files are UTF-8, or UTF-16LE like the word lists if they have its BOM or NUL bytes
+static std::wstring ReadText(const wchar_t* filename, int64_t* size) {
+    auto bytes = static_cast<char*>(ReadWholeFile(filename, size));
+    std::string_view data(bytes, static_cast<size_t>(*size));
+    bool utf16 = data.starts_with("\xff\xfe") || data.find('\0') != std::string_view::npos;
+    std::wstring text;
+    if (!utf16) {
+        DecodeUtf8(data.starts_with("\xef\xbb\xbf") ? data.substr(3) : data, text);
+    }
+    FreeFile(bytes);
+    if (utf16) {
+        size_t length;
+        auto words = ReadWordList(filename, &length);
+        text.assign(words, length);
+        FreeFile(words);
+        if (text.starts_with(L'\xfeff')) {
+            text.erase(0, 1);
+        }
+    }
+    return text;
+}
+
+static bool WriteUtf8(const wchar_t* filename, std::wstring_view text) {
+    std::string utf8(EncodeUtf8(text, {}), '\0');
+    EncodeUtf8(text, utf8);
+    std::ofstream file(std::filesystem::path(filename), std::ios::binary);
+    if (!file.write(utf8.data(), static_cast<std::streamsize>(utf8.size()))) {
+        wprintf(L"failed to write %ls\n", filename);
+        return false;
+    }
+    return true;
+}
+
+static const std::pair<TypingStyles, const wchar_t*>* FindStyle(const wchar_t* stylename) {
+    auto style = std::find_if(std::begin(styles), std::end(styles), [=](const auto& s) {
+        return !wcscmp(s.second, stylename);
+    });
+    if (style == std::end(styles)) {
+        wprintf(L"unknown typing style %ls\n", stylename);
+        return nullptr;
+    }
+    return style;
+}
+
+// chunks end right after a character that isn't part of a word, so that no word spans two chunks
+template <typename IsWordChar>
+static std::vector<std::wstring_view> SplitChunks(std::wstring_view text, size_t count, IsWordChar isWordChar) {
+    std::vector<std::wstring_view> chunks;
+    size_t begin = 0;
+    for (size_t i = 1; i <= count && begin < text.size(); i++) {
+        auto end = i == count ? text.size() : std::max(begin, text.size() * i / count);
+        while (end < text.size() && isWordChar(text[end])) {
+            end++;
+        }
+        if (end > begin) {
+            chunks.push_back(text.substr(begin, end - begin));
+        }
+        begin = end;
+    }
+    return chunks;
+}
+
+// one converter per thread, reassembled in chunk order. statistics gets the sum of the cache statistics of all threads
+static std::wstring ConvertChunks(
+    const TelexConfig& config,
+    size_t cacheCapacity,
+    const std::vector<std::wstring_view>& chunks,
+    WordCache::Statistics& statistics) {
+    std::vector<std::wstring> outputs(chunks.size());
+    std::vector<WordCache::Statistics> chunkStatistics(chunks.size());
+    {
+        std::vector<std::jthread> workers;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            workers.emplace_back([&, i] {
+                TextConverter converter(config, cacheCapacity);
+                outputs[i].reserve(chunks[i].size() + chunks[i].size() / 8);
+                converter.Convert(chunks[i], outputs[i]);
+                converter.Flush(outputs[i]);
+                chunkStatistics[i] = converter.GetStatistics();
+            });
+        }
+    }
+    size_t total = 0;
+    for (const auto& output : outputs) {
+        total += output.size();
+    }
+    std::wstring result;
+    result.reserve(total);
+    for (const auto& output : outputs) {
+        result += output;
+    }
+    statistics = {};
+    for (const auto& s : chunkStatistics) {
+        statistics.hits += s.hits;
+        statistics.misses += s.misses;
+        statistics.evictions += s.evictions;
+        statistics.retypes += s.retypes;
+    }
+    return result;
+}
+
+bool convert(const wchar_t* stylename, const wchar_t* input, const wchar_t* output) {
+    auto style = FindStyle(stylename);
+    if (!style) {
+        return false;
+    }
+    TelexConfig config;
+    config.typing_style = style->first;
+
+    int64_t size;
+    auto text = ReadText(input, &size);
+    TextConverter classifier(config, 0);
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < std::thread::hardware_concurrency(); threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(std::max(1u, std::thread::hardware_concurrency()));
+
+    // every thread count runs with the cache and without it, the speedup is against 1 thread with the cache
+    std::wstring converted;
+    double baseline = 0;
+    for (auto threads : threadCounts) {
+        for (auto cacheCapacity : {TextConverter::DefaultCacheCapacity, size_t(0)}) {
+            auto t1 = std::chrono::high_resolution_clock::now();
+            auto chunks = SplitChunks(text, threads, [&](wchar_t c) { return classifier.AcceptsChar(c); });
+            WordCache::Statistics stats;
+            auto result = ConvertChunks(config, cacheCapacity, chunks, stats);
+            auto t2 = std::chrono::high_resolution_clock::now();
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+            auto seconds = std::max<double>(static_cast<double>(us), 1) / 1e6;
+            if (threads == 1 && cacheCapacity) {
+                converted = std::move(result);
+                baseline = seconds;
+            } else if (result != converted) {
+                wprintf(
+                    L"threads %u%ls: output differs from 1 thread with the cache\n",
+                    threads,
+                    cacheCapacity ? L"" : L" uncached");
+                return false;
+            }
+            wprintf(
+                L"%ls threads %u %ls: chunks = %zu, hits = %zu, misses = %zu, retypes = %zu, time = %llu us, "
+                L"%.1f MB/s, speedup = %.2fx\n",
+                style->second,
+                threads,
+                cacheCapacity ? L"cached" : L"uncached",
+                chunks.size(),
+                stats.hits,
+                stats.misses,
+                stats.retypes,
+                static_cast<unsigned long long>(us),
+                static_cast<double>(size) / 1e6 / seconds,
+                baseline / seconds);
+        }
+    }
+
+    return !output || WriteUtf8(output, converted);
+}
+
+bool backconvert(const wchar_t* stylename, const wchar_t* input, const wchar_t* output) {
+    auto style = FindStyle(stylename);
+    if (!style) {
+        return false;
+    }
+    TelexConfig config;
+    config.typing_style = style->first;
+
+    int64_t size;
+    auto text = ReadText(input, &size);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    TextBackconverter classifier(config);
+    auto chunks = SplitChunks(text, std::max(1u, std::thread::hardware_concurrency()), [&](wchar_t c) {
+        return classifier.IsWordChar(c);
+    });
+    std::vector<std::wstring> outputs(chunks.size());
+    std::vector<std::vector<BackconvertFailure>> failures(chunks.size());
+    {
+        std::vector<std::jthread> workers;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            workers.emplace_back([&, i] {
+                TextBackconverter converter(config, static_cast<size_t>(chunks[i].data() - text.data()));
+                outputs[i].reserve(chunks[i].size() + chunks[i].size() / 4);
+                converter.Convert(chunks[i], outputs[i], failures[i]);
+                converter.Flush(outputs[i], failures[i]);
+            });
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    size_t failed = 0;
+    for (const auto& chunkFailures : failures) {
+        for (const auto& f : chunkFailures) {
+            auto word = text.substr(f.offset, f.length);
+            wprintf(L"%zu %ls %d\n", f.offset, word.c_str(), static_cast<int>(f.state));
+        }
+        failed += chunkFailures.size();
+    }
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+    wprintf(
+        L"%ls backconvert: threads = %zu, failures = %zu, time = %llu us, %.1f MB/s\n",
+        style->second,
+        chunks.size(),
+        failed,
+        static_cast<unsigned long long>(us),
+        static_cast<double>(size) / 1e6 / (std::max<double>(static_cast<double>(us), 1) / 1e6));
+
+    if (output) {
+        std::wstring keys;
+        for (const auto& chunkOutput : outputs) {
+            keys += chunkOutput;
+        }
+        return WriteUtf8(output, keys);
+    }
+    return true;
+}
@@ -6,6 +6,7 @@
 #include "WordListIterator.hpp"
 #include "FileUtil.hpp"
 #include "TelexEngine.h"
+#include "ParallelScan.h"
 
 using namespace VietType::Telex;
 using namespace VietType::TestLib;
@@ -16,22 +17,20 @@ enum DualScanMode {
 };
 
 bool dualscan(int mode) {
-    std::set<std::wstring> vwordset;
-    {
-        int64_t vfsize;
-        auto vpath = std::filesystem::path("..") / ".." / "data" / "vw39kw.txt";
-        auto vwords = static_cast<wchar_t*>(ReadWholeFile(vpath, &vfsize));
-        auto vwend = vwords + vfsize / sizeof(wchar_t);
-        for (WordListIterator vw(vwords, vwend); vw != vwend; vw++) {
-            vwordset.insert(std::wstring(*vw, vw.wlen()));
-        }
-        FreeFile(vwords);
+    // vwords stays loaded for the set to point into
+    size_t vlength;
+    auto vpath = std::filesystem::path("..") / ".." / "data" / "vw39kw.txt";
+    auto vwords = ReadWordList(vpath, &vlength);
+    auto vwordlist = CollectWords(vwords, vwords + vlength);
+    FlatWordSet vwordset(vwordlist.size());
+    for (auto vword : vwordlist) {
+        vwordset.insert(vword);
     }
 
-    int64_t efsize;
+    size_t elength;
     auto epath = std::filesystem::path("..") / ".." / "data" / "ewdsw.txt";
-    auto ewords = static_cast<wchar_t*>(ReadWholeFile(epath, &efsize));
-    auto ewend = ewords + efsize / sizeof(wchar_t);
+    auto ewords = ReadWordList(epath, &elength);
+    auto ewend = ewords + elength;
     TelexConfig config;
     switch (mode) {
     case WlistEn2:
@@ -43,31 +42,39 @@ bool dualscan(int mode) {
         config.autocorrect = true;
         break;
     }
-    TelexEngine engine(config);
-    for (WordListIterator ew(ewords, ewend); ew != ewend; ew++) {
-        std::wstring eword(*ew, ew.wlen());
-        engine.Reset();
-        for (auto c : eword) {
-            engine.PushChar(c);
-        }
-        if (engine.Commit() == TelexStates::Committed) {
-            auto outword = engine.Retrieve();
-            switch (mode) {
-            case WlistEn2:
-                if (vwordset.find(outword) == vwordset.end() &&
-                    std::any_of(
-                        engine.GetRespos().begin(), engine.GetRespos().end(), [](auto x) { return x & ~ResposMask; })) {
-                    wprintf(L"%ls\n", eword.c_str());
-                }
-                break;
-            case WlistEnAc:
-                if (engine.IsAutocorrected()) {
-                    wprintf(L"%ls\n", eword.c_str());
+    auto ewordlist = CollectWords(ewords, ewend);
+    auto results = ParallelScan(
+        ewordlist.size(),
+        [&] { return TelexEngine(config); },
+        [&](TelexEngine& engine, size_t i, std::wstring& out) {
+            auto eword = ewordlist[i];
+            engine.Reset();
+            for (auto c : eword) {
+                engine.PushChar(c);
+            }
+            if (engine.Commit() == TelexStates::Committed) {
+                auto outword = engine.Retrieve();
+                switch (mode) {
+                case WlistEn2:
+                    if (!vwordset.contains(outword) &&
+                        std::any_of(engine.GetRespos().begin(), engine.GetRespos().end(), [](auto x) {
+                            return x & ~ResposMask;
+                        })) {
+                        out.append(eword).append(L"\n");
+                    }
+                    break;
+                case WlistEnAc:
+                    if (engine.IsAutocorrected()) {
+                        out.append(eword).append(L"\n");
+                    }
+                    break;
                 }
-                break;
             }
-        }
+        });
+    for (const auto& result : results) {
+        wprintf(L"%ls", result.c_str());
     }
     FreeFile(ewords);
+    FreeFile(vwords);
     return true;
 }
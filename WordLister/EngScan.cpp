@@ -6,43 +6,53 @@
 #include "WordListIterator.hpp"
 #include "FileUtil.hpp"
 #include "TelexEngine.h"
+#include "ParallelScan.h"
 
 using namespace VietType::Telex;
 using namespace VietType::TestLib;
 
-static TelexStates TestWord(TelexEngine& e, const wchar_t* input) {
+static TelexStates TestWord(TelexEngine& e, std::wstring_view input) {
     e.Reset();
-    for (auto c : std::wstring(input)) {
+    for (auto c : input) {
         e.PushChar(c);
     }
     return e.Commit();
 }
 
 bool engscan(const wchar_t* filename) {
-    int64_t fsize;
-    auto words = static_cast<wchar_t*>(ReadWholeFile(filename, &fsize));
-    auto wend = words + fsize / sizeof(wchar_t);
+    size_t length;
+    auto words = ReadWordList(filename, &length);
+    auto wend = words + length;
 
     TelexConfig config;
     config.optimize_multilang = 0;
-    TelexEngine engine(config);
-    for (WordListIterator w(words, wend); w != wend; w++) {
-        std::wstring word(*w, w.wlen());
-
-        auto state = TestWord(engine, word.c_str());
-        if (state == TelexStates::Committed && engine.GetTone() != Tones::Z) {
-            const wchar_t* wordclass = L"";
-            if (std::count_if(
-                    engine.GetRespos().begin(), engine.GetRespos().end(), [](auto x) { return x & ResposTone; }) > 1)
-                wordclass = L"DoubleTone";
-            else if (!(*engine.GetRespos().rbegin() & ResposTone))
-                wordclass = L"ToneNotEnd";
-            wprintf(L"%s %ls\n", word.c_str(), wordclass);
-        } else if (std::any_of(engine.GetRespos().begin(), engine.GetRespos().end(), [](auto x) {
-                       return x & ResposDoubleUndo;
-                   })) {
-            wprintf(L"%s %ls\n", word.c_str(), L"DoubleUndo");
-        }
+    auto wordlist = CollectWords(words, wend);
+    auto results = ParallelScan(
+        wordlist.size(),
+        [&] { return TelexEngine(config); },
+        [&](TelexEngine& engine, size_t i, std::wstring& out) {
+            auto word = wordlist[i];
+            auto state = TestWord(engine, word);
+            const wchar_t* wordclass;
+            if (state == TelexStates::Committed && engine.GetTone() != Tones::Z) {
+                wordclass = L"";
+                if (std::count_if(engine.GetRespos().begin(), engine.GetRespos().end(), [](auto x) {
+                        return x & ResposTone;
+                    }) > 1)
+                    wordclass = L"DoubleTone";
+                else if (!(*engine.GetRespos().rbegin() & ResposTone))
+                    wordclass = L"ToneNotEnd";
+            } else if (std::any_of(engine.GetRespos().begin(), engine.GetRespos().end(), [](auto x) {
+                           return x & ResposDoubleUndo;
+                       })) {
+                wordclass = L"DoubleUndo";
+            } else {
+                return;
+            }
+            out.append(word).append(L" ").append(wordclass).append(L"\n");
+        });
+    for (const auto& result : results) {
+        wprintf(L"%ls", result.c_str());
     }
     FreeFile(words);
     return true;
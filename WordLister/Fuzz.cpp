@@ -4,79 +4,182 @@
 #include "stdafx.h"
 #include "Telex.h"
 #include "TelexEngine.h"
+#include "FuzzTables.h"
 
 using namespace VietType::Telex;
 
-struct FuzzWorkItem {
+struct FuzzJob {
     int len = 0;
     TypingStyles style = TypingStyles::Max;
     std::wstring_view table{};
-    int start = 0;
-    int end = 0;
     int mode = 0;
 };
 
-static constexpr const int skip = 1;
-static constexpr const std::wstring_view table_telex = L"acdefghinoqsuwyz";
-static constexpr const std::wstring_view table_telex_complicated = L"acdefghinoqsuwyz[]";
-static constexpr const std::wstring_view table_vni = L"acdeghinoquy0126789";
+// each word is typed with every optimize_multilang level, with and without autocorrect
+static constexpr const int configs_per_word = 4 * 2;
+// the last keys of a word are always typed by the worker that owns its prefix
+static constexpr const int leaf_keys = 3;
 
+// a task covers the words of a job whose first depth keys, read as a number in base table.size(), are in
+// [begin, end of the block of table.size() prefixes that begin is in).
+// packed as job | depth << 8 | begin << 16 so that the deques can hold them in plain atomics
+struct FuzzTask {
+    uint32_t job;
+    uint32_t depth;
+    uint64_t begin;
+
+    uint64_t Pack() const {
+        return job | depth << 8 | begin << 16;
+    }
+    static FuzzTask Unpack(uint64_t task) {
+        return FuzzTask{
+            .job = static_cast<uint32_t>(task & 0xff),
+            .depth = static_cast<uint32_t>((task >> 8) & 0xff),
+            .begin = task >> 16,
+        };
+    }
+};
+
+/// <summary>
+/// Chase-Lev deque of the continuations of one worker. the owner pushes and pops at the bottom, thieves steal from the
+/// top, which holds the largest ranges. a worker holds at most one continuation for each depth, so the deque never
+/// wraps around
+/// </summary>
+class FuzzDeque {
+public:
+    static constexpr size_t Capacity = 16;
+
+    void Push(uint64_t task) {
+        auto bottom = _bottom.load(std::memory_order_relaxed);
+        if (bottom - _top.load(std::memory_order_acquire) >= static_cast<int64_t>(Capacity)) {
+            throw std::runtime_error("fuzz deque overflow");
+        }
+        _tasks[bottom % Capacity].store(task, std::memory_order_relaxed);
+        _bottom.store(bottom + 1, std::memory_order_seq_cst);
+    }
+
+    bool Pop(uint64_t* task) {
+        auto bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(bottom, std::memory_order_seq_cst);
+        auto top = _top.load(std::memory_order_seq_cst);
+        if (top > bottom) {
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+        *task = _tasks[bottom % Capacity].load(std::memory_order_relaxed);
+        if (top < bottom) {
+            return true;
+        }
+        // last task, race the thieves for it
+        auto won = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst);
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    bool Steal(uint64_t* task) {
+        auto top = _top.load(std::memory_order_seq_cst);
+        auto bottom = _bottom.load(std::memory_order_seq_cst);
+        if (top >= bottom) {
+            return false;
+        }
+        *task = _tasks[top % Capacity].load(std::memory_order_relaxed);
+        return _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, Capacity> _tasks{};
+    std::atomic<int64_t> _top = 0;
+    std::atomic<int64_t> _bottom = 0;
+};
+
+struct FuzzScheduler {
+    std::vector<FuzzJob> jobs;
+    std::vector<FuzzDeque> deques;
+    // index of the next job that no worker has started
+    std::atomic<size_t> next_job = 0;
+    // workers that have work or are trying to steal some; when none are left, all deques are empty
+    std::atomic<size_t> active = 0;
+    std::atomic<uint64_t> words_done = 0;
+    std::atomic<size_t> workers_done = 0;
+};
+
+static bool SameState(const TelexEngine& a, const TelexEngine& b) {
+    return a.GetState() == b.GetState() && a.Peek() == b.Peek() && a.RetrieveRaw() == b.RetrieveRaw() &&
+           a.GetTone() == b.GetTone() && a.IsBackconverted() == b.IsBackconverted() &&
+           std::ranges::equal(a.GetRespos(), b.GetRespos());
+}
+
+static uint64_t Power(uint64_t base, int exponent) {
+    uint64_t result = 1;
+    for (auto i = 0; i < exponent; i++) {
+        result *= base;
+    }
+    return result;
+}
+
+// types the words of a task that has a single prefix
 template <size_t table_size>
-static void DoFuzz(const FuzzWorkItem& wi) {
-    if (wi.table.size() != table_size) {
+static void FuzzLeaf(const FuzzJob& job, const FuzzTask& task) {
+    if (job.table.size() != table_size) {
         throw std::runtime_error("invalid table size");
     }
+    std::array<wchar_t, 8> prefix{};
+    if (task.depth > prefix.size()) {
+        throw std::runtime_error("invalid task depth");
+    }
+    auto cur = task.begin;
+    for (auto j = task.depth; j > 0; j--) {
+        prefix[j - 1] = job.table[cur % table_size];
+        cur /= table_size;
+    }
+    auto max = Power(table_size, job.len - static_cast<int>(task.depth));
     for (int level = 0; level <= 3; level++) {
         for (int autocorrect = 0; autocorrect <= 1; autocorrect++) {
-#if _DEBUG
-            wprintf(
-                L"len %d style %d ts %zu start %d end %d mode %d level %d autocorrect %d\n",
-                wi.len,
-                (int)wi.style,
-                wi.table.size(),
-                wi.start,
-                wi.end,
-                wi.mode,
-                level,
-                autocorrect);
-#endif
             TelexConfig config;
             config.optimize_multilang = level;
             config.autocorrect = !!autocorrect;
-            config.typing_style = wi.style;
+            config.typing_style = job.style;
             TelexEngine e(config);
-            for (int prefix = wi.start; prefix < wi.end; prefix++) {
-                size_t max = 1;
-                for (auto i = 1; i < wi.len; i++) {
-                    max *= table_size;
+            for (uint64_t i = 0; i < max; i++) {
+                e.Reset();
+                for (uint32_t j = 0; j < task.depth; j++) {
+                    e.PushChar(prefix[j]);
+                }
+                auto cur = i;
+                for (auto j = task.depth; j < static_cast<uint32_t>(job.len); j++) {
+                    e.PushChar(job.table[cur % table_size]);
+                    cur /= table_size;
                 }
-                for (size_t i = 0; i < max; i++) {
-                    e.Reset();
-                    size_t cur = i;
-                    e.PushChar(wi.table[prefix]);
-                    for (auto j = 1; j < wi.len; j++) {
-                        e.PushChar(wi.table[cur % table_size]);
-                        cur /= table_size;
+                auto keyBuffer = e.RetrieveRaw();
+                if (!e.CheckInvariants()) {
+                    wprintf(L"word failed: %ls\n", keyBuffer.c_str());
+                }
+                if (job.mode == 0) {
+                    if (e.Commit() == TelexStates::TxError) {
+                        wprintf(L"word failed commit: %ls\n", keyBuffer.c_str());
                     }
-                    auto keyBuffer = e.RetrieveRaw();
                     if (!e.CheckInvariants()) {
-                        wprintf(L"word failed: %s\n", keyBuffer.c_str());
+                        wprintf(L"word failed commit invariant: %ls\n", keyBuffer.c_str());
+                    }
+                } else {
+                    // SetConfig drops the undo snapshots, so this copy has to replay the word on every backspace
+                    TelexEngine replayed(e);
+                    replayed.SetConfig(config);
+                    auto prevState = e.GetState();
+                    if (e.Backspace() == TelexStates::TxError) {
+                        wprintf(L"word failed backspace: %ls\n", keyBuffer.c_str());
+                    }
+                    if (!e.CheckInvariantsBackspace(prevState)) {
+                        wprintf(L"word failed backspace invariant: %ls\n", keyBuffer.c_str());
+                    }
+                    replayed.Backspace();
+                    while (SameState(e, replayed) && e.Count()) {
+                        e.Backspace();
+                        replayed.SetConfig(config);
+                        replayed.Backspace();
                     }
-                    if (wi.mode == 0) {
-                        if (e.Commit() == TelexStates::TxError) {
-                            wprintf(L"word failed commit: %s\n", keyBuffer.c_str());
-                        }
-                        if (!e.CheckInvariants()) {
-                            wprintf(L"word failed commit invariant: %s\n", keyBuffer.c_str());
-                        }
-                    } else {
-                        auto prevState = e.GetState();
-                        if (e.Backspace() == TelexStates::TxError) {
-                            wprintf(L"word failed backspace: %s\n", keyBuffer.c_str());
-                        }
-                        if (!e.CheckInvariantsBackspace(prevState)) {
-                            wprintf(L"word failed backspace invariant: %s\n", keyBuffer.c_str());
-                        }
+                    if (!SameState(e, replayed)) {
+                        wprintf(L"word failed backspace replay: %ls\n", keyBuffer.c_str());
                     }
                 }
             }
@@ -84,26 +187,77 @@ static void DoFuzz(const FuzzWorkItem& wi) {
     }
 }
 
-static void FuzzWorker(std::deque<FuzzWorkItem>* wq, std::mutex* wq_lock) {
-    while (1) {
-        FuzzWorkItem wi;
-        {
-            std::lock_guard guard(*wq_lock);
-            if (wq->empty())
-                break;
-            wi = wq->front();
-            wq->pop_front();
+// runs a task and the continuations that it leaves in the deque of the worker
+static void FuzzRun(FuzzScheduler* s, FuzzDeque& deque, FuzzTask task) {
+    while (true) {
+        const auto& job = s->jobs[task.job];
+        auto ts = job.table.size();
+        // the rest of the block stays up for grabs while this prefix is typed
+        if ((task.begin + 1) % ts) {
+            deque.Push(FuzzTask{task.job, task.depth, task.begin + 1}.Pack());
+        }
+        if (job.len - static_cast<int>(task.depth) > leaf_keys) {
+            task = FuzzTask{task.job, task.depth + 1, task.begin * ts};
+            continue;
         }
-        if (wi.table.size() == table_telex.size()) {
-            DoFuzz<table_telex.size()>(wi);
-        } else if (wi.table.size() == table_telex_complicated.size()) {
-            DoFuzz<table_telex_complicated.size()>(wi);
-        } else if (wi.table.size() == table_vni.size()) {
-            DoFuzz<table_vni.size()>(wi);
+        if (ts == table_telex.size()) {
+            FuzzLeaf<table_telex.size()>(job, task);
+        } else if (ts == table_telex_complicated.size()) {
+            FuzzLeaf<table_telex_complicated.size()>(job, task);
+        } else if (ts == table_vni.size()) {
+            FuzzLeaf<table_vni.size()>(job, task);
         } else {
             throw std::runtime_error("invalid table size");
         }
+        s->words_done.fetch_add(Power(ts, job.len - task.depth) * configs_per_word, std::memory_order_relaxed);
+        uint64_t packed;
+        if (!deque.Pop(&packed)) {
+            return;
+        }
+        task = FuzzTask::Unpack(packed);
+    }
+}
+
+static bool FuzzSteal(FuzzScheduler* s, size_t self, FuzzTask* task) {
+    while (true) {
+        // count ourselves as active before looking, so that nobody sees all workers idle while we hold a task
+        s->active.fetch_add(1);
+        for (size_t i = 1; i < s->deques.size(); i++) {
+            uint64_t packed;
+            if (s->deques[(self + i) % s->deques.size()].Steal(&packed)) {
+                *task = FuzzTask::Unpack(packed);
+                return true;
+            }
+        }
+        if (s->active.fetch_sub(1) == 1) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+}
+
+static void FuzzWorker(FuzzScheduler* s, size_t self) {
+    while (true) {
+        FuzzTask task;
+        if (auto job = s->next_job.fetch_add(1); job < s->jobs.size()) {
+#if _DEBUG
+            wprintf(
+                L"len %d style %d ts %zu mode %d\n",
+                s->jobs[job].len,
+                (int)s->jobs[job].style,
+                s->jobs[job].table.size(),
+                s->jobs[job].mode);
+#endif
+            task = FuzzTask{static_cast<uint32_t>(job), 1, 0};
+        } else {
+            s->active.fetch_sub(1);
+            if (!FuzzSteal(s, self, &task)) {
+                break;
+            }
+        }
+        FuzzRun(s, s->deques[self], task);
     }
+    s->workers_done.fetch_add(1);
 }
 
 bool fuzz() {
@@ -111,83 +265,61 @@ bool fuzz() {
     SetPriorityClass(GetCurrentProcess(), IDLE_PRIORITY_CLASS);
     SetThreadExecutionState(ES_SYSTEM_REQUIRED | ES_CONTINUOUS);
 #endif
-    {
-        std::deque<FuzzWorkItem> wq;
-        std::mutex wq_lock;
-        for (auto len = 1; len <= 5; len++) {
-            for (auto mode = 0; mode <= 1; mode++) {
-                wq.emplace_back(
-                    FuzzWorkItem{
-                        .len = len,
-                        .style = TypingStyles::Telex,
-                        .table = table_telex,
-                        .start = 0,
-                        .end = (int)table_telex.size(),
-                        .mode = mode,
-                    });
-                wq.emplace_back(
-                    FuzzWorkItem{
-                        .len = len,
-                        .style = TypingStyles::TelexComplicated,
-                        .table = table_telex_complicated,
-                        .start = 0,
-                        .end = (int)table_telex_complicated.size(),
-                        .mode = mode,
-                    });
-                wq.emplace_back(
-                    FuzzWorkItem{
-                        .len = len,
-                        .style = TypingStyles::Vni,
-                        .table = table_vni,
-                        .start = 0,
-                        .end = (int)table_vni.size(),
-                        .mode = mode,
-                    });
-            }
-        }
-        for (auto len = 6; len <= 7; len++) {
-            for (auto mode = 0; mode <= 1; mode++) {
-                for (int i = 0; i < table_telex.size(); i += skip) {
-                    wq.emplace_back(
-                        FuzzWorkItem{
-                            .len = len,
-                            .style = TypingStyles::Telex,
-                            .table = table_telex,
-                            .start = i,
-                            .end = std::min(i + skip, (int)table_telex.size()),
-                            .mode = mode,
-                        });
-                }
-                for (int i = 0; i < table_telex_complicated.size(); i += skip) {
-                    wq.emplace_back(
-                        FuzzWorkItem{
-                            .len = len,
-                            .style = TypingStyles::TelexComplicated,
-                            .table = table_telex_complicated,
-                            .start = i,
-                            .end = std::min(i + skip, (int)table_telex_complicated.size()),
-                            .mode = mode,
-                        });
-                }
-                for (int i = 0; i < table_vni.size(); i += skip) {
-                    wq.emplace_back(
-                        FuzzWorkItem{
-                            .len = len,
-                            .style = TypingStyles::Vni,
-                            .table = table_vni,
-                            .start = i,
-                            .end = std::min(i + skip, (int)table_vni.size()),
-                            .mode = mode,
-                        });
-                }
-            }
+    auto threads = std::max(1u, std::thread::hardware_concurrency());
+    FuzzScheduler s;
+    // longest words first, so that the short jobs fill in at the end
+    for (auto len = 7; len >= 1; len--) {
+        for (auto mode = 0; mode <= 1; mode++) {
+            s.jobs.push_back(FuzzJob{.len = len, .style = TypingStyles::Telex, .table = table_telex, .mode = mode});
+            s.jobs.push_back(
+                FuzzJob{
+                    .len = len,
+                    .style = TypingStyles::TelexComplicated,
+                    .table = table_telex_complicated,
+                    .mode = mode,
+                });
+            s.jobs.push_back(FuzzJob{.len = len, .style = TypingStyles::Vni, .table = table_vni, .mode = mode});
         }
+    }
+    uint64_t total = 0;
+    for (const auto& job : s.jobs) {
+        total += Power(job.table.size(), job.len) * configs_per_word;
+    }
+    s.deques = std::vector<FuzzDeque>(threads);
+    s.active = threads;
 
+    auto report = [&](std::chrono::steady_clock::duration elapsed) {
+        auto done = s.words_done.load(std::memory_order_relaxed);
+        auto seconds = std::chrono::duration<double>(elapsed).count();
+        auto rate = seconds > 0 ? done / seconds : 0;
+        wprintf(
+            L"fuzz: %.1f%% (%llu/%llu words), %.0f s, %.0f words/s, %.0f words/s per core\n",
+            100.0 * done / total,
+            static_cast<unsigned long long>(done),
+            static_cast<unsigned long long>(total),
+            seconds,
+            rate,
+            rate / threads);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    {
         std::vector<std::jthread> workers;
-        for (unsigned int i = 0; i < std::thread::hardware_concurrency(); i++) {
-            workers.emplace_back(FuzzWorker, &wq, &wq_lock);
+        for (size_t i = 0; i < threads; i++) {
+            workers.emplace_back(FuzzWorker, &s, i);
+        }
+        auto next_report = start + std::chrono::seconds(10);
+        while (s.workers_done.load() < threads) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (std::chrono::steady_clock::now() >= next_report) {
+                report(std::chrono::steady_clock::now() - start);
+                next_report += std::chrono::seconds(10);
+            }
         }
     }
+    report(std::chrono::steady_clock::now() - start);
+#if _WIN32
     SetThreadExecutionState(ES_CONTINUOUS);
+#endif
     return true;
 }
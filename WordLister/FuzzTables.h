@@ -0,0 +1,11 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <string_view>
+
+// keys that fuzzing draws from for each typing style
+static constexpr const std::wstring_view table_telex = L"acdefghinoqsuwyz";
+static constexpr const std::wstring_view table_telex_complicated = L"acdefghinoqsuwyz[]";
+static constexpr const std::wstring_view table_vni = L"acdeghinoquy0126789";
@@ -0,0 +1,193 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "WordListIterator.hpp"
+
+// views into the word list, which must outlive them
+inline std::vector<std::wstring_view> CollectWords(const wchar_t* words, const wchar_t* wend) {
+    std::vector<std::wstring_view> result;
+    for (VietType::TestLib::WordListIterator w(words, wend); w != wend; w++) {
+        result.emplace_back(*w, w.wlen());
+    }
+    return result;
+}
+
+// the range of items that a worker has left, as begin << 32 | end so that it can be split with one CAS
+class WorkRange {
+public:
+    void Assign(uint32_t begin, uint32_t end) {
+        _range.store(Pack(begin, end), std::memory_order_release);
+    }
+
+    /// <summary>
+    /// owner: takes up to grain items from the front
+    /// </summary>
+    bool Take(uint32_t grain, uint32_t* begin, uint32_t* end) {
+        auto range = _range.load(std::memory_order_acquire);
+        while (true) {
+            auto [b, e] = Unpack(range);
+            if (b >= e) {
+                return false;
+            }
+            auto taken = std::min(e, b + grain);
+            if (_range.compare_exchange_weak(range, Pack(taken, e), std::memory_order_acq_rel)) {
+                *begin = b;
+                *end = taken;
+                return true;
+            }
+        }
+    }
+
+    /// <summary>
+    /// thief: takes the back half
+    /// </summary>
+    bool Steal(uint32_t* begin, uint32_t* end) {
+        auto range = _range.load(std::memory_order_acquire);
+        while (true) {
+            auto [b, e] = Unpack(range);
+            if (e - b < 2 || b >= e) {
+                return false;
+            }
+            auto mid = b + (e - b) / 2;
+            if (_range.compare_exchange_weak(range, Pack(b, mid), std::memory_order_acq_rel)) {
+                *begin = mid;
+                *end = e;
+                return true;
+            }
+        }
+    }
+
+    uint32_t Remaining() const {
+        auto [b, e] = Unpack(_range.load(std::memory_order_relaxed));
+        return b < e ? e - b : 0;
+    }
+
+private:
+    static constexpr uint64_t Pack(uint32_t begin, uint32_t end) {
+        return (static_cast<uint64_t>(begin) << 32) | end;
+    }
+    static constexpr std::pair<uint32_t, uint32_t> Unpack(uint64_t range) {
+        return {static_cast<uint32_t>(range >> 32), static_cast<uint32_t>(range)};
+    }
+
+    std::atomic<uint64_t> _range = 0;
+};
+
+/// <summary>
+/// calls scan(state, i, out) for every i in [0, count) on one thread per core, each with its own state from
+/// makeState(). each worker starts with an even share of the items and steals half of the largest share left when it
+/// runs out. the output of each item goes into its own string so that the results come back in item order no matter
+/// which thread ran them. the first exception thrown by scan is rethrown once all workers have stopped
+/// </summary>
+template <typename MakeState, typename Scan>
+std::vector<std::wstring> ParallelScan(size_t count, MakeState makeState, Scan scan) {
+    static constexpr uint32_t grain = 64;
+    std::vector<std::wstring> outputs(count);
+    auto threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<WorkRange> ranges(threads);
+    for (size_t i = 0; i < threads; i++) {
+        ranges[i].Assign(static_cast<uint32_t>(count * i / threads), static_cast<uint32_t>(count * (i + 1) / threads));
+    }
+
+    std::mutex errorLock;
+    std::exception_ptr error;
+    std::atomic<bool> failed = false;
+    auto work = [&](size_t self) {
+        auto state = makeState();
+        uint32_t begin, end;
+        while (!failed.load(std::memory_order_relaxed)) {
+            if (!ranges[self].Take(grain, &begin, &end)) {
+                // the largest share is the most likely to still have work once we get to it
+                size_t victim = self;
+                for (size_t i = 0; i < ranges.size(); i++) {
+                    if (ranges[i].Remaining() > ranges[victim].Remaining()) {
+                        victim = i;
+                    }
+                }
+                if (victim == self || !ranges[victim].Steal(&begin, &end)) {
+                    if (std::all_of(ranges.begin(), ranges.end(), [](const auto& r) { return !r.Remaining(); })) {
+                        return;
+                    }
+                    std::this_thread::yield();
+                    continue;
+                }
+                ranges[self].Assign(begin, end);
+                continue;
+            }
+            for (auto i = begin; i < end; i++) {
+                scan(state, i, outputs[i]);
+            }
+        }
+    };
+    auto worker = [&](size_t self) {
+        try {
+            work(self);
+        } catch (...) {
+            std::lock_guard lock(errorLock);
+            if (!error) {
+                error = std::current_exception();
+            }
+            // the items left in the range of this worker can't be finished by thieves
+            failed = true;
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        for (size_t i = 1; i < threads; i++) {
+            workers.emplace_back(worker, i);
+        }
+        worker(0);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return outputs;
+}
+
+/// <summary>
+/// open addressing set of views into a word list that outlives it
+/// </summary>
+class FlatWordSet {
+public:
+    explicit FlatWordSet(size_t expected) : _slots(std::bit_ceil(std::max<size_t>(16, expected * 2))) {
+    }
+
+    void insert(std::wstring_view word) {
+        auto& slot = Find(word);
+        if (!slot.data()) {
+            slot = word;
+        }
+    }
+    bool contains(std::wstring_view word) const {
+        return const_cast<FlatWordSet*>(this)->Find(word).data() != nullptr;
+    }
+
+private:
+    // the slot of word, or the empty slot where it would go
+    std::wstring_view& Find(std::wstring_view word) {
+        auto mask = _slots.size() - 1;
+        for (auto i = std::hash<std::wstring_view>()(word) & mask;; i = (i + 1) & mask) {
+            if (!_slots[i].data() || _slots[i] == word) {
+                return _slots[i];
+            }
+        }
+    }
+
+    // empty slots have no data, the empty word points into the list
+    std::vector<std::wstring_view> _slots;
+};
@@ -6,32 +6,39 @@
 #include "WordListIterator.hpp"
 #include "FileUtil.hpp"
 #include "TelexEngine.h"
+#include "ParallelScan.h"
 
 using namespace VietType::Telex;
 using namespace VietType::TestLib;
 
 bool vietscan(const wchar_t* filename) {
-    int64_t fsize;
-    auto words = static_cast<wchar_t*>(ReadWholeFile(filename, &fsize));
-    auto wend = words + fsize / sizeof(wchar_t);
+    size_t length;
+    auto words = ReadWordList(filename, &length);
+    auto wend = words + length;
 
-    TelexConfig config;
-    TelexEngine engine(config);
-    for (WordListIterator w(words, wend); w != wend; w++) {
-        std::wstring word(*w, w.wlen());
+    auto wordlist = CollectWords(words, wend);
 
-        engine.Reset();
-        auto state = engine.Backconvert(word);
-        switch (state) {
-        case TelexStates::Valid:
-            break;
-        case TelexStates::Invalid:
-        case TelexStates::BackconvertFailed:
-            wprintf(L"%s %d\n", word.c_str(), static_cast<int>(state));
-            break;
-        default:
-            throw std::runtime_error("unexpected state");
-        }
+    TelexConfig config;
+    auto results = ParallelScan(
+        wordlist.size(),
+        [&] { return TelexEngine(config); },
+        [&](TelexEngine& engine, size_t i, std::wstring& out) {
+            auto word = std::wstring(wordlist[i]);
+            engine.Reset();
+            auto state = engine.Backconvert(word);
+            switch (state) {
+            case TelexStates::Valid:
+                break;
+            case TelexStates::Invalid:
+            case TelexStates::BackconvertFailed:
+                out = word + L" " + std::to_wstring(static_cast<int>(state)) + L"\n";
+                break;
+            default:
+                throw std::runtime_error("unexpected state");
+            }
+        });
+    for (const auto& result : results) {
+        wprintf(L"%ls", result.c_str());
     }
     FreeFile(words);
     return true;
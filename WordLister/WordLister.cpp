@@ -8,17 +8,35 @@ bool engscan(const wchar_t* filename);
 bool dualscan(int mode);
 bool bench();
 bool fuzz();
-
-static_assert(sizeof(wchar_t) == 2, "VietTypeUnitTests assumes 16-bit wchar_t");
+bool automaton();
+bool convert(const wchar_t* stylename, const wchar_t* input, const wchar_t* output);
+bool backconvert(const wchar_t* stylename, const wchar_t* input, const wchar_t* output);
 
 #ifdef _WIN32
 int wmain(int argc, wchar_t** argv) {
 #else
+int wmain_shim(int argc, wchar_t** argv);
+
 int main(int argc, char** argv) {
-    (void)argc;
-    (void)argv;
-    return 1;
+    // word lists are widened to UTF-32 on load, and wprintf needs a UTF-8 locale to print them
+    if (!setlocale(LC_ALL, "C.UTF-8")) {
+        setlocale(LC_ALL, "");
+    }
+    std::vector<std::wstring> args;
+    for (int i = 0; i < argc; i++) {
+        std::wstring arg(strlen(argv[i]), L'\0');
+        auto length = mbstowcs(arg.data(), argv[i], arg.size());
+        arg.resize(length == static_cast<size_t>(-1) ? 0 : length);
+        args.push_back(std::move(arg));
+    }
+    std::vector<wchar_t*> wargv;
+    for (auto& arg : args) {
+        wargv.push_back(arg.data());
+    }
+    wargv.push_back(nullptr);
+    return wmain_shim(argc, wargv.data());
 }
+
 int wmain_shim(int argc, wchar_t** argv) {
 #endif
     if (argc == 3 && !wcscmp(argv[1], L"vietscan")) {
@@ -28,19 +46,28 @@ int wmain_shim(int argc, wchar_t** argv) {
     } else if (argc >= 2 && !wcscmp(argv[1], L"dualscan")) {
         int mode = 0;
         if (argc >= 3)
-            mode = _wtoi(argv[2]);
+            mode = static_cast<int>(wcstol(argv[2], nullptr, 10));
         return !dualscan(mode);
     } else if (argc == 2 && !wcscmp(argv[1], L"bench")) {
         return !bench();
     } else if (argc == 2 && !wcscmp(argv[1], L"fuzz")) {
         return !fuzz();
+    } else if (argc == 2 && !wcscmp(argv[1], L"automaton")) {
+        return !automaton();
+    } else if ((argc == 4 || argc == 5) && !wcscmp(argv[1], L"convert")) {
+        return !convert(argv[2], argv[3], argc == 5 ? argv[4] : nullptr);
+    } else if ((argc == 4 || argc == 5) && !wcscmp(argv[1], L"backconvert")) {
+        return !backconvert(argv[2], argv[3], argc == 5 ? argv[4] : nullptr);
     } else {
         wprintf(
             L"usage: \n"
             L"    wordlister <vietscan|engscan> <filename>\n"
             L"    wordlister dualscan\n"
             L"    wordlister bench\n"
-            L"    wordlister fuzz\n");
+            L"    wordlister fuzz\n"
+            L"    wordlister automaton\n"
+            L"    wordlister convert <telex|vni|telex-complicated> <input> [output]\n"
+            L"    wordlister backconvert <telex|vni|telex-complicated> <input> [output]\n");
         return 1;
     }
 }
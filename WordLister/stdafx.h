@@ -11,10 +11,14 @@
 
 #include <cstring>
 #include <cstdio>
+#include <clocale>
+#include <cstdlib>
 #include <stdexcept>
 #include <system_error>
 #include <string>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <cwchar>
@@ -22,3 +26,5 @@
 #include <thread>
 #include <mutex>
 #include <deque>
+#include <memory>
+#include <vector>